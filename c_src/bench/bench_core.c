@@ -0,0 +1,306 @@
+// Microbenchmark suite for the single-game core API
+// Times update_game, spawn_food, check_self_collision, set_direction and
+// reset_game across board sizes and snake lengths. Each case is warmed up,
+// then timed as many short batches whose per-call cost gives a median and
+// p99; results go to stdout and, with --json, to a file for tracking
+// regressions between releases.
+//
+// Usage: bench_core [--json PATH] [--cpu N]
+//   --json PATH  also write the results as JSON to PATH
+//   --cpu N      pin the benchmark to CPU N (default: the CPU it starts on)
+
+#define _GNU_SOURCE
+#include "snake_core.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#define SAMPLES 201           // Timed batches per case
+#define WARMUP_SAMPLES 20     // Untimed batches run before them
+#define SAMPLE_NS 20000.0     // Batches are sized to take at least this long
+#define PROBE_COUNT 4096      // Cells queried by the collision benchmark (power of two)
+#define MAX_CASES 128
+
+// Board swept by the suite; storage boards get lengths up to 90% of the board
+typedef struct {
+    int width;
+    int height;
+    bool storage;       // Caller storage sized for the board instead of the embedded arrays
+} BoardConfig;
+
+// State shared by the operations being timed
+typedef struct {
+    GameState* game;
+    Direction* cycle;   // Direction the Hamiltonian cycle takes out of each cell
+    Point* probes;      // Cells for check_self_collision, spread over the board
+    unsigned sink;      // Consumes results so calls are not optimized away
+} BenchContext;
+
+// One measured case
+typedef struct {
+    const char* op;
+    int width;
+    int height;
+    bool storage;
+    int length;
+    long batch;         // Calls per timed batch
+    double median_ns;
+    double p99_ns;
+    double min_ns;
+    double mean_ns;
+} BenchResult;
+
+static BenchResult results[MAX_CASES];
+static int result_count = 0;
+
+// Grow the snake along the cycle to length, then park the food off the board
+// so timed ticks move the snake without ever eating
+static void grow_to(BenchContext* ctx, int length) {
+    GameState* game = ctx->game;
+    while (game->snake_length < length && !game->game_over) cycle_grow_once(game);
+    game->food.position.x = -1;
+    game->food.position.y = -1;
+}
+
+// Operations under test; each runs count calls back to back
+
+static void run_update_game(BenchContext* ctx, long count) {
+    GameState* game = ctx->game;
+    for (long n = 0; n < count; n++) {
+        Point head = game->body[game->snake_head].position;
+        game->direction = ctx->cycle[head.y * game->width + head.x];
+        update_game(game);
+    }
+}
+
+static void run_spawn_food(BenchContext* ctx, long count) {
+    for (long n = 0; n < count; n++) spawn_food(ctx->game);
+}
+
+static void run_check_self_collision(BenchContext* ctx, long count) {
+    unsigned hits = 0;
+    for (long n = 0; n < count; n++) {
+        hits += check_self_collision(ctx->game, ctx->probes[n & (PROBE_COUNT - 1)]);
+    }
+    ctx->sink += hits;
+}
+
+// Queues four distinct turns, then empties the queue so every call takes the
+// enqueue path rather than bouncing off a full queue
+static void run_set_direction(BenchContext* ctx, long count) {
+    static const Direction turns[4] = {UP, LEFT, DOWN, RIGHT};
+    GameState* game = ctx->game;
+    for (long n = 0; n < count; n++) {
+        set_direction(game, turns[n & 3]);
+        if ((n & 3) == 3) game->input_count = 0;
+    }
+    game->input_count = 0;
+}
+
+static void run_reset_game(BenchContext* ctx, long count) {
+    for (long n = 0; n < count; n++) reset_game(ctx->game);
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Calibrate, warm up and time one operation, recording the result
+static void measure(const char* op, void (*run)(BenchContext*, long), BenchContext* ctx,
+                    const BoardConfig* board) {
+    if (result_count == MAX_CASES) return;
+    
+    // Double the batch until it takes SAMPLE_NS; this also warms caches
+    long batch = 1;
+    for (;;) {
+        double start = now_ns();
+        run(ctx, batch);
+        if (now_ns() - start >= SAMPLE_NS || batch >= (1L << 24)) break;
+        batch *= 2;
+    }
+    for (int s = 0; s < WARMUP_SAMPLES; s++) run(ctx, batch);
+    
+    static double samples[SAMPLES];
+    double total = 0.0;
+    for (int s = 0; s < SAMPLES; s++) {
+        double start = now_ns();
+        run(ctx, batch);
+        samples[s] = (now_ns() - start) / (double)batch;
+        total += samples[s];
+    }
+    qsort(samples, SAMPLES, sizeof(double), compare_doubles);
+    
+    BenchResult* result = &results[result_count++];
+    result->op = op;
+    result->width = board->width;
+    result->height = board->height;
+    result->storage = board->storage;
+    result->length = ctx->game->snake_length;
+    result->batch = batch;
+    result->median_ns = samples[SAMPLES / 2];
+    result->p99_ns = samples[(SAMPLES - 1) * 99 / 100];
+    result->min_ns = samples[0];
+    result->mean_ns = total / SAMPLES;
+    
+    printf("%-22s %5dx%-5d %-8s %9d %10ld %11.1f %11.1f\n", op, board->width, board->height,
+           board->storage ? "caller" : "embedded", result->length, batch,
+           result->median_ns, result->p99_ns);
+    fflush(stdout);
+}
+
+// Run every operation on one board across its snake lengths
+static bool bench_board(const BoardConfig* board) {
+    static GameState game;
+    if (!cycle_fits(board->width, board->height)) {
+        fprintf(stderr, "%dx%d board does not fit the growth cycle\n", board->width, board->height);
+        return false;
+    }
+    
+    int cells = board->width * board->height;
+    size_t storage_size = board->storage ? game_storage_size(board->width, board->height) : 0;
+    void* storage = board->storage ? malloc(storage_size) : NULL;
+    Direction* cycle = malloc((size_t)cells * sizeof(Direction));
+    Point* probes = malloc(PROBE_COUNT * sizeof(Point));
+    if ((board->storage && !storage) || !cycle || !probes) {
+        fprintf(stderr, "failed to allocate buffers for a %dx%d board\n", board->width, board->height);
+        free(storage);
+        free(cycle);
+        free(probes);
+        return false;
+    }
+    
+    for (int y = 0; y < board->height; y++) {
+        for (int x = 0; x < board->width; x++) {
+            Point p = {x, y};
+            cycle[y * board->width + x] = cycle_direction(p, board->width, board->height);
+        }
+    }
+    srand(1);
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        probes[i].x = rand() % board->width;
+        probes[i].y = rand() % board->height;
+    }
+    
+    if (board->storage) {
+        initialize_game_with_storage(&game, board->width, board->height, storage, storage_size);
+    } else {
+        initialize_game(&game, board->width, board->height);
+    }
+    seed_game(&game, 1, 1);
+    BenchContext ctx = {&game, cycle, probes, 0};
+    
+    // Lengths only grow, so each one continues from the previous
+    int lengths[4] = {INITIAL_SNAKE_LENGTH, cells / 4, cells / 2, cells * 9 / 10};
+    if (!board->storage) {
+        lengths[1] = game.capacity / 4;
+        lengths[2] = game.capacity / 2;
+        lengths[3] = game.capacity;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (i > 0 && lengths[i] <= lengths[i - 1]) continue;
+        grow_to(&ctx, lengths[i]);
+        measure("update_game", run_update_game, &ctx, board);
+        measure("check_self_collision", run_check_self_collision, &ctx, board);
+        measure("set_direction", run_set_direction, &ctx, board);
+        measure("spawn_food", run_spawn_food, &ctx, board);
+    }
+    
+    // Resetting rewrites the whole board whatever the length, so time it once
+    measure("reset_game", run_reset_game, &ctx, board);
+    
+    free(storage);
+    free(cycle);
+    free(probes);
+    return true;
+}
+
+// Pin the process to one CPU so samples are not spread across cores
+static int pin_cpu(int cpu) {
+#ifdef __linux__
+    if (cpu < 0) cpu = sched_getcpu();
+    if (cpu < 0) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        fprintf(stderr, "could not pin to CPU %d, running unpinned\n", cpu);
+        return -1;
+    }
+    return cpu;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+// Write every result as a JSON document
+static bool write_json(const char* path, int cpu) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+    
+    fprintf(file, "{\n  \"benchmark\": \"snake_core\",\n  \"unit\": \"ns/op\",\n");
+    fprintf(file, "  \"cpu\": %d,\n  \"samples\": %d,\n  \"game_state_bytes\": %zu,\n",
+            cpu, SAMPLES, sizeof(GameState));
+    fprintf(file, "  \"results\": [\n");
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(file, "    {\"op\": \"%s\", \"width\": %d, \"height\": %d, \"storage\": \"%s\", "
+                "\"length\": %d, \"batch\": %ld, \"median_ns\": %.2f, \"p99_ns\": %.2f, "
+                "\"min_ns\": %.2f, \"mean_ns\": %.2f}%s\n",
+                r->op, r->width, r->height, r->storage ? "caller" : "embedded", r->length,
+                r->batch, r->median_ns, r->p99_ns, r->min_ns, r->mean_ns,
+                i + 1 < result_count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    
+    bool ok = fclose(file) == 0;
+    if (ok) printf("Wrote %d results to %s\n", result_count, path);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    int cpu = -1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            cpu = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--json PATH] [--cpu N]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    // Heights are multiples of 4 to fit the growth cycle (see cycle_fits);
+    // 20x16 stands in for the GUI's 20x15 board
+    const BoardConfig boards[] = {
+        {20, 16, false},
+        {64, 64, false},
+        {64, 64, true},
+        {256, 256, true},
+        {1024, 1024, true},
+    };
+    const int board_count = (int)(sizeof(boards) / sizeof(boards[0]));
+    
+    cpu = pin_cpu(cpu);
+    printf("snake core microbenchmarks (%d samples per case, pinned to CPU %d)\n", SAMPLES, cpu);
+    printf("%-22s %11s %-8s %9s %10s %11s %11s\n", "operation", "board", "storage",
+           "length", "batch", "median ns", "p99 ns");
+    
+    for (int i = 0; i < board_count; i++) {
+        if (!bench_board(&boards[i])) return 1;
+    }
+    
+    if (json_path && !write_json(json_path, cpu)) return 1;
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Microbenchmark for the segment scan kernels in snake_scan.c
+// Times a worst-case search (position not on the snake) for the scalar and
+// vector kernels across snake lengths from 3 to 65536.
+
+#define _POSIX_C_SOURCE 199309L
+#include "snake_scan.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_LENGTH 65536
+#define TARGET_SEGMENTS 50000000L  // Segments compared per measurement
+
+// Time one kernel on the first length segments; returns ns per call
+static double time_kernel(int (*kernel)(const SnakeSegment*, int, Point),
+                          const SnakeSegment* segments, int length, Point missing) {
+    long calls = TARGET_SEGMENTS / length;
+    if (calls < 100) calls = 100;
+    
+    volatile int sink = 0;
+    for (long n = 0; n < calls / 10 + 1; n++) sink += kernel(segments, length, missing);
+    
+    double start = now_ns();
+    for (long n = 0; n < calls; n++) sink += kernel(segments, length, missing);
+    double elapsed = now_ns() - start;
+    
+    (void)sink;
+    return elapsed / (double)calls;
+}
+
+int main(void) {
+    const int lengths[] = {3, 8, 16, 64, 256, 1024, 4096, 16384, 65536};
+    const int count = (int)(sizeof(lengths) / sizeof(lengths[0]));
+    
+    // A serpentine body on a 256x256 board, so coordinates vary like a real snake
+    SnakeSegment* segments = malloc(sizeof(SnakeSegment) * MAX_LENGTH);
+    if (!segments) return 1;
+    for (int i = 0; i < MAX_LENGTH; i++) {
+        int row = i / 256;
+        segments[i].position.x = row % 2 == 0 ? i % 256 : 255 - i % 256;
+        segments[i].position.y = row;
+    }
+    Point missing = {-1, -1};
+    
+    // Sanity check: every kernel must agree with the scalar loop
+    Point probe = segments[MAX_LENGTH - 5].position;
+    if (scan_segments_sse2(segments, MAX_LENGTH, probe) != MAX_LENGTH - 5 ||
+        scan_segments_avx2(segments, MAX_LENGTH, probe) != MAX_LENGTH - 5) {
+        fprintf(stderr, "vector kernels disagree with the scalar kernel\n");
+        return 1;
+    }
+    
+    printf("segment scan, dispatched kernel: %s\n", scan_segments_kernel());
+    printf("%8s %12s %12s %12s %9s\n", "length", "scalar ns", "sse2 ns", "avx2 ns", "speedup");
+    for (int i = 0; i < count; i++) {
+        int length = lengths[i];
+        double scalar = time_kernel(scan_segments_scalar, segments, length, missing);
+        double sse2 = time_kernel(scan_segments_sse2, segments, length, missing);
+        double avx2 = time_kernel(scan_segments_avx2, segments, length, missing);
+        double best = sse2 < avx2 ? sse2 : avx2;
+        printf("%8d %12.1f %12.1f %12.1f %8.1fx\n", length, scalar, sse2, avx2, scalar / best);
+    }
+    
+    free(segments);
+    return 0;
+}
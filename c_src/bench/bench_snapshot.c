@@ -0,0 +1,148 @@
+// Benchmark for snapshot_game / restore_game clone throughput
+// Grows the snake to several lengths on a GUI-sized board (embedded storage) and
+// on full-board 64x64 and 256x256 games, then times snapshots into a bump arena
+// and restores from it against plain copies of everything a GameState owns,
+// out to the same arena and back. The speedup compares the two round trips.
+
+#define _POSIX_C_SOURCE 199309L
+#include "snake_core.h"
+#include "snake_snapshot.h"
+#include "bench_util.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_SIZE (16 << 20)
+#define TARGET_BYTES 4000000000L  // Bytes the full-copy baseline moves per measurement
+
+// Put a plain copy of a game made by copy_out back into clone, keeping the
+// clone's own storage pointers
+static void copy_in(GameState* clone, const unsigned char* saved, size_t storage_size) {
+    SnakeSegment* body = clone->body;
+    unsigned char* occupied = clone->occupied;
+    int* free_cells = clone->free_cells;
+    int* free_slot = clone->free_slot;
+    memcpy(clone, saved, sizeof(GameState));
+    if (storage_size) {
+        memcpy(body, saved + sizeof(GameState), storage_size);
+        clone->body = body;
+        clone->occupied = occupied;
+        clone->free_cells = free_cells;
+        clone->free_slot = free_slot;
+    } else {
+        clone->body = clone->snake;
+        clone->occupied = clone->occupied_storage;
+        clone->free_cells = clone->free_cells_storage;
+        clone->free_slot = clone->free_slot_storage;
+    }
+}
+
+// Time snapshots and restores of game at its current length against plain
+// copies of everything a GameState owns, out to the same arena and back
+static void measure(GameState* game, GameState* clone, size_t storage_size,
+                    unsigned char* arena) {
+    size_t size = snapshot_size(game);
+    size_t copy_size = sizeof(GameState) + storage_size;
+    long iterations = TARGET_BYTES / (long)copy_size;
+    if (iterations < 2000) iterations = 2000;
+    
+    // Snapshots go into a bump arena that wraps around when full
+    size_t used = 0;
+    for (long n = 0; n < iterations / 10 + 1; n++) {
+        if (used + size > ARENA_SIZE) used = 0;
+        used += snapshot_game(game, arena + used, ARENA_SIZE - used);
+    }
+    double start = now_ns();
+    used = 0;
+    for (long n = 0; n < iterations; n++) {
+        if (used + size > ARENA_SIZE) used = 0;
+        used += snapshot_game(game, arena + used, ARENA_SIZE - used);
+    }
+    double snapshot_ns = (now_ns() - start) / (double)iterations;
+    
+    // Restore into a clone from the first snapshot in the arena
+    snapshot_game(game, arena, ARENA_SIZE);
+    start = now_ns();
+    for (long n = 0; n < iterations; n++) {
+        restore_game(clone, arena, ARENA_SIZE);
+    }
+    double restore_ns = (now_ns() - start) / (double)iterations;
+    
+    // Baseline: copy the whole struct plus any caller storage into the same arena
+    used = 0;
+    start = now_ns();
+    for (long n = 0; n < iterations; n++) {
+        if (used + copy_size > ARENA_SIZE) used = 0;
+        memcpy(arena + used, game, sizeof(GameState));
+        if (storage_size) memcpy(arena + used + sizeof(GameState), game->body, storage_size);
+        used += copy_size;
+        __asm__ __volatile__("" ::: "memory");
+    }
+    double copy_out_ns = (now_ns() - start) / (double)iterations;
+    
+    // ... and back into the clone from the first copy
+    start = now_ns();
+    for (long n = 0; n < iterations; n++) {
+        copy_in(clone, arena, storage_size);
+        __asm__ __volatile__("" ::: "memory");
+    }
+    double copy_in_ns = (now_ns() - start) / (double)iterations;
+    
+    double clone_ns = snapshot_ns + restore_ns;
+    printf("%8d %10zu %10zu %11.1f %11.1f %11.1f %11.1f %8.1fx\n", game->snake_length, size,
+           copy_size, snapshot_ns, restore_ns, copy_out_ns, copy_in_ns,
+           (copy_out_ns + copy_in_ns) / clone_ns);
+}
+
+// Measure full-board games on caller storage at each of count lengths
+static bool measure_board(GameState* game, GameState* clone, int width, int height,
+                          const int* lengths, int count, unsigned char* arena) {
+    if (!cycle_fits(width, height)) return false;
+    
+    size_t storage_size = game_storage_size(width, height);
+    void* storage = malloc(storage_size);
+    void* clone_storage = malloc(storage_size);
+    if (!storage || !clone_storage) return false;
+    
+    printf("%dx%d board, caller storage (%zu bytes)\n", width, height, storage_size);
+    for (int i = 0; i < count; i++) {
+        initialize_game_with_storage(game, width, height, storage, storage_size);
+        initialize_game_with_storage(clone, width, height, clone_storage, storage_size);
+        while (game->snake_length < lengths[i] && !game->game_over) cycle_grow_once(game);
+        measure(game, clone, storage_size, arena);
+    }
+    
+    free(storage);
+    free(clone_storage);
+    return true;
+}
+
+int main(void) {
+    static GameState game, clone;
+    unsigned char* arena = aligned_alloc(8, ARENA_SIZE);
+    if (!arena) return 1;
+    
+    printf("%8s %10s %10s %11s %11s %11s %11s %9s\n", "length", "bytes", "copy bytes",
+           "snapshot ns", "restore ns", "copy out ns", "copy in ns", "speedup");
+    
+    // GUI-sized board on the embedded arrays (sizeof(GameState) bytes per full copy);
+    // 16 rows rather than 15 to fit the growth cycle
+    const int small_lengths[] = {3, 25, 50, 100};
+    printf("20x16 board, embedded storage (GameState is %zu bytes)\n", sizeof(GameState));
+    for (int i = 0; i < 4; i++) {
+        initialize_game(&game, 20, 16);
+        initialize_game(&clone, 20, 16);
+        while (game.snake_length < small_lengths[i] && !game.game_over) cycle_grow_once(&game);
+        measure(&game, &clone, 0, arena);
+    }
+    
+    // Full-board games on caller storage, up to nearly full snakes
+    const int medium_lengths[] = {3, 1024, 2048, 4000};
+    const int large_lengths[] = {3, 16384, 32768, 65000};
+    if (!measure_board(&game, &clone, 64, 64, medium_lengths, 4, arena) ||
+        !measure_board(&game, &clone, 256, 256, large_lengths, 4, arena)) return 1;
+    
+    free(arena);
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Benchmark for spawn_food latency across board occupancy levels
+// Grows the snake along a Hamiltonian cycle to each target length and then
+// times repeated spawn_food calls, which should cost the same at 1% and 99%.
+
+#define _POSIX_C_SOURCE 199309L
+#include "snake_core.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Board used for the sweep (must satisfy cycle_fits)
+#define BOARD_WIDTH 1024
+#define BOARD_HEIGHT 1024
+#define SPAWN_ITERATIONS 200000
+
+int main(void) {
+    static GameState game;
+    const int cells = BOARD_WIDTH * BOARD_HEIGHT;
+    const int percents[] = {1, 10, 25, 50, 75, 90, 95, 99};
+    const int count = (int)(sizeof(percents) / sizeof(percents[0]));
+    
+    if (!cycle_fits(BOARD_WIDTH, BOARD_HEIGHT)) return 1;
+    
+    // Size the body for the whole board so the snake can reach 99%
+    size_t storage_size = game_storage_size(BOARD_WIDTH, BOARD_HEIGHT);
+    void* storage = malloc(storage_size);
+    if (!storage) {
+        fprintf(stderr, "failed to allocate %zu bytes of game storage\n", storage_size);
+        return 1;
+    }
+    
+    printf("spawn_food latency on a %dx%d board (%d iterations)\n",
+           BOARD_WIDTH, BOARD_HEIGHT, SPAWN_ITERATIONS);
+    printf("%10s %9s %12s\n", "occupancy", "length", "ns/spawn");
+    
+    for (int i = 0; i < count; i++) {
+        int target = cells * percents[i] / 100;
+        if (target < INITIAL_SNAKE_LENGTH) target = INITIAL_SNAKE_LENGTH;
+        
+        initialize_game_with_storage(&game, BOARD_WIDTH, BOARD_HEIGHT, storage, storage_size);
+        while (game.snake_length < target && !game.game_over) {
+            cycle_grow_once(&game);
+        }
+        
+        // Warm up, then time the spawn path only
+        for (int n = 0; n < 1000; n++) spawn_food(&game);
+        double start = now_ns();
+        for (int n = 0; n < SPAWN_ITERATIONS; n++) spawn_food(&game);
+        double elapsed = now_ns() - start;
+        
+        printf("%9.0f%% %9d %12.1f\n", 100.0 * game.snake_length / cells,
+               game.snake_length, elapsed / SPAWN_ITERATIONS);
+    }
+    
+    free(storage);
+    return 0;
+}
@@ -0,0 +1,262 @@
+// End-to-end throughput benchmark: independent headless games on 1..P threads
+// Each thread owns a slice of the games and steps them round-robin with
+// initialize_game / set_direction / update_game / reset_game, restarting any
+// game that ends. Reports aggregate ticks/s, foods/s and episodes/s for every
+// thread count, plus the scaling efficiency against a single thread, so it
+// doubles as the baseline for changes to the core data structures.
+//
+// Usage: bench_throughput [--games N] [--threads P] [--seconds S]
+//                         [--policy random|greedy|autopilot]
+//   --games N      games in play, split evenly across the threads (default 256)
+//   --threads P    largest thread count to sweep (default: online CPUs)
+//   --seconds S    run time per thread count (default 1.0)
+//   --policy NAME  random turns, greedy steps toward the food, or the BFS
+//                  autopilot (default random)
+
+#define _POSIX_C_SOURCE 200809L
+#include "snake_core.h"
+#include "snake_autopilot.h"
+#include "bench_util.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BOARD_WIDTH 20   // Same board as the GUI
+#define BOARD_HEIGHT 15
+
+typedef enum {
+    POLICY_RANDOM,
+    POLICY_GREEDY,
+    POLICY_AUTOPILOT
+} Policy;
+
+// Per-thread work and results, padded so counters do not share cache lines
+typedef struct {
+    _Alignas(64) GameState* games;
+    int game_count;
+    Policy policy;
+    uint64_t rng;       // xorshift64 state for the policy
+    AutopilotScratch scratch;  // Search arena for the autopilot policy
+    void* scratch_storage;
+    uint64_t ticks;
+    uint64_t foods;
+    uint64_t episodes;
+    pthread_t thread;
+} Worker;
+
+static atomic_bool stop_flag;
+static pthread_barrier_t start_barrier;
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+// Shortest distance between two cells on the wrap-around board
+static int torus_distance(Point a, Point b) {
+    int dx = abs(a.x - b.x);
+    int dy = abs(a.y - b.y);
+    if (dx > BOARD_WIDTH - dx) dx = BOARD_WIDTH - dx;
+    if (dy > BOARD_HEIGHT - dy) dy = BOARD_HEIGHT - dy;
+    return dx + dy;
+}
+
+// Pick the safe non-reversing move that gets closest to the food, breaking ties
+// at random; keeps going straight if every move is fatal
+static Direction greedy_direction(GameState* game, uint64_t* rng) {
+    Point head = get_snake_segment(game, 0);
+    Point food = get_food_position(game);
+    Direction current = game->direction;
+    Direction best = current;
+    int best_score = -1;
+    
+    for (int d = 0; d < 4; d++) {
+        Direction dir = (Direction)d;
+        if ((dir + 2) % 4 == current) continue;
+        Point next = wrap_step(head, dir, BOARD_WIDTH, BOARD_HEIGHT);
+        if (check_self_collision(game, next)) continue;
+        int score = 4 * (BOARD_WIDTH + BOARD_HEIGHT - torus_distance(next, food)) +
+                    (int)(next_random(rng) & 3);
+        if (score > best_score) {
+            best_score = score;
+            best = dir;
+        }
+    }
+    return best;
+}
+
+// Step the worker's games until told to stop
+static void* run_worker(void* arg) {
+    Worker* worker = (Worker*)arg;
+    uint64_t ticks = 0, foods = 0, episodes = 0;
+    
+    pthread_barrier_wait(&start_barrier);
+    while (!atomic_load_explicit(&stop_flag, memory_order_relaxed)) {
+        for (int i = 0; i < worker->game_count; i++) {
+            GameState* game = &worker->games[i];
+            if (worker->policy == POLICY_AUTOPILOT) {
+                set_direction(game, autopilot_choose_direction(game, &worker->scratch));
+            } else if (worker->policy == POLICY_GREEDY) {
+                set_direction(game, greedy_direction(game, &worker->rng));
+            } else if ((next_random(&worker->rng) & 7) == 0) {
+                set_direction(game, (Direction)(next_random(&worker->rng) & 3));
+            }
+            
+            int score = get_score(game);
+            update_game(game);
+            ticks++;
+            if (get_score(game) != score) foods++;
+            if (is_game_over(game)) {
+                reset_game(game);
+                episodes++;
+            }
+        }
+    }
+    
+    worker->ticks = ticks;
+    worker->foods = foods;
+    worker->episodes = episodes;
+    return NULL;
+}
+
+// Run every game on thread_count threads for seconds; returns false on failure
+static bool run_threads(int thread_count, int game_count, Policy policy, double seconds,
+                        double* ticks_per_second, double* foods_per_second,
+                        double* episodes_per_second) {
+    Worker* workers = aligned_alloc(64, sizeof(Worker) * (size_t)thread_count);
+    if (!workers) return false;
+    memset(workers, 0, sizeof(Worker) * (size_t)thread_count);
+    
+    bool ok = true;
+    int started = 0;
+    for (int t = 0; t < thread_count; t++) {
+        Worker* worker = &workers[t];
+        worker->game_count = game_count / thread_count + (t < game_count % thread_count);
+        worker->policy = policy;
+        worker->rng = 0x9E3779B97F4A7C15ULL * (uint64_t)(t + 1);
+        worker->games = malloc(sizeof(GameState) * (size_t)worker->game_count);
+        size_t scratch_size = autopilot_scratch_size(BOARD_WIDTH, BOARD_HEIGHT);
+        worker->scratch_storage = malloc(scratch_size);
+        if (!worker->games || !worker->scratch_storage ||
+            !autopilot_init(&worker->scratch, BOARD_WIDTH, BOARD_HEIGHT,
+                            worker->scratch_storage, scratch_size)) {
+            ok = false;
+            break;
+        }
+        for (int i = 0; i < worker->game_count; i++) {
+            initialize_game(&worker->games[i], BOARD_WIDTH, BOARD_HEIGHT);
+        }
+    }
+    
+    if (ok) {
+        atomic_store(&stop_flag, false);
+        pthread_barrier_init(&start_barrier, NULL, (unsigned)thread_count + 1);
+        for (; started < thread_count; started++) {
+            if (pthread_create(&workers[started].thread, NULL, run_worker, &workers[started]) != 0) break;
+        }
+        if (started < thread_count) {
+            // The barrier cannot open without every thread, so there is no way back
+            fprintf(stderr, "failed to start thread %d\n", started);
+            exit(1);
+        }
+        
+        pthread_barrier_wait(&start_barrier);
+        double start = now_ns();
+        struct timespec duration = {(time_t)seconds, (long)((seconds - (double)(time_t)seconds) * 1e9)};
+        nanosleep(&duration, NULL);
+        atomic_store(&stop_flag, true);
+        for (int t = 0; t < thread_count; t++) pthread_join(workers[t].thread, NULL);
+        double elapsed = (now_ns() - start) / 1e9;
+        pthread_barrier_destroy(&start_barrier);
+        
+        uint64_t ticks = 0, foods = 0, episodes = 0;
+        for (int t = 0; t < thread_count; t++) {
+            ticks += workers[t].ticks;
+            foods += workers[t].foods;
+            episodes += workers[t].episodes;
+        }
+        *ticks_per_second = (double)ticks / elapsed;
+        *foods_per_second = (double)foods / elapsed;
+        *episodes_per_second = (double)episodes / elapsed;
+    }
+    
+    for (int t = 0; t < thread_count; t++) {
+        free(workers[t].games);
+        free(workers[t].scratch_storage);
+    }
+    free(workers);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int game_count = 256;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = online > 0 ? (int)online : 1;
+    double seconds = 1.0;
+    Policy policy = POLICY_RANDOM;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            game_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "random") == 0) {
+                policy = POLICY_RANDOM;
+            } else if (strcmp(name, "greedy") == 0) {
+                policy = POLICY_GREEDY;
+            } else if (strcmp(name, "autopilot") == 0) {
+                policy = POLICY_AUTOPILOT;
+            } else {
+                fprintf(stderr, "unknown policy %s\n", name);
+                return 2;
+            }
+        } else {
+            fprintf(stderr, "usage: %s [--games N] [--threads P] [--seconds S] "
+                    "[--policy random|greedy|autopilot]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (game_count < 1 || max_threads < 1 || seconds <= 0.0) {
+        fprintf(stderr, "games, threads and seconds must be positive\n");
+        return 2;
+    }
+    if (max_threads > game_count) max_threads = game_count;
+    
+    const char* policy_names[] = {"random", "greedy", "autopilot"};
+    printf("%d games on a %dx%d board, %s policy, %.1f s per run\n", game_count,
+           BOARD_WIDTH, BOARD_HEIGHT, policy_names[policy], seconds);
+    printf("%8s %14s %12s %12s %16s %11s\n", "threads", "ticks/s", "foods/s",
+           "episodes/s", "ticks/s/thread", "efficiency");
+    
+    // Powers of two up to the limit, and the limit itself
+    double single_thread_rate = 0.0;
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        double ticks, foods, episodes;
+        if (!run_threads(threads, game_count, policy, seconds, &ticks, &foods, &episodes)) {
+            fprintf(stderr, "failed to allocate %d games\n", game_count);
+            return 1;
+        }
+        if (threads == 1) single_thread_rate = ticks;
+        
+        double efficiency = ticks / ((double)threads * single_thread_rate);
+        printf("%8d %14.0f %12.0f %12.0f %16.0f %10.0f%%\n", threads, ticks, foods,
+               episodes, ticks / threads, 100.0 * efficiency);
+        fflush(stdout);
+        if (threads == max_threads) break;
+    }
+    return 0;
+}
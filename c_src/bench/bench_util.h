@@ -0,0 +1,57 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Helpers shared by the benchmark programs, so every harness reads the same
+// clock and grows its snakes the same way. Each benchmark is a single source
+// file, so everything here is static inline.
+
+#include <stdbool.h>
+#include <time.h>
+#include "snake_core.h"
+
+// Monotonic clock in nanoseconds
+static inline double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Cell one step from p in dir, wrapping around the board edges
+static inline Point wrap_step(Point p, Direction dir, int width, int height) {
+    switch (dir) {
+        case UP:    p.y = (p.y - 1 + height) % height; break;
+        case RIGHT: p.x = (p.x + 1) % width; break;
+        case DOWN:  p.y = (p.y + 1) % height; break;
+        case LEFT:  p.x = (p.x - 1 + width) % width; break;
+    }
+    return p;
+}
+
+// Benchmarks grow snakes along a Hamiltonian cycle: even rows run right, odd
+// rows run left down to column 1, and the last row continues into column 0,
+// which runs back up to row 0. The snake starts heading right on row
+// height / 2, so the height must be a multiple of 4: even, so the last row
+// runs left, with an even middle row, so the start is on the cycle.
+static inline bool cycle_fits(int width, int height) {
+    return width >= MIN_BOARD_WIDTH && height >= 4 && height % 4 == 0;
+}
+
+// Direction the cycle takes out of p
+static inline Direction cycle_direction(Point p, int width, int height) {
+    if (p.x == 0) return p.y == 0 ? RIGHT : UP;
+    if (p.y % 2 == 0) return p.x == width - 1 ? DOWN : RIGHT;
+    if (p.x == 1 && p.y != height - 1) return DOWN;
+    return LEFT;
+}
+
+// Grow the snake by one segment along the cycle by placing food right in
+// front of the head
+static inline void cycle_grow_once(GameState* game) {
+    Point head = get_snake_segment(game, 0);
+    Direction dir = cycle_direction(head, game->width, game->height);
+    game->direction = dir;
+    game->food.position = wrap_step(head, dir, game->width, game->height);
+    update_game(game);
+}
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,138 @@
+#include "snake_autopilot.h"
+#include "snake_internal.h"
+#include <string.h>
+
+// Bytes of scratch storage a width x height board needs
+size_t autopilot_scratch_size(int width, int height) {
+    if (width < 1 || height < 1 || width > MAX_STORAGE_CELLS / height) return 0;
+    
+    // Queue, then visit stamps, then the byte-sized first moves
+    size_t cells = (size_t)width * (size_t)height;
+    return cells * (sizeof(int) + sizeof(uint32_t) + sizeof(unsigned char));
+}
+
+// Set up scratch on caller storage
+bool autopilot_init(AutopilotScratch* scratch, int width, int height,
+                    void* storage, size_t storage_size) {
+    size_t needed = autopilot_scratch_size(width, height);
+    if (!scratch || !storage || needed == 0 || storage_size < needed) return false;
+    if ((uintptr_t)storage % sizeof(int) != 0) return false;
+    
+    size_t cells = (size_t)width * (size_t)height;
+    unsigned char* cursor = (unsigned char*)storage;
+    
+    scratch->queue = (int*)cursor;
+    cursor += cells * sizeof(int);
+    scratch->stamp = (uint32_t*)cursor;
+    cursor += cells * sizeof(uint32_t);
+    scratch->first_move = cursor;
+    scratch->cells = (int)cells;
+    
+    memset(scratch->stamp, 0, cells * sizeof(uint32_t));
+    scratch->generation = 0;
+    return true;
+}
+
+// Start a new search; bumping the generation marks every cell unvisited, and
+// the stamps only need clearing when the counter wraps
+static uint32_t next_generation(AutopilotScratch* scratch) {
+    if (++scratch->generation == 0) {
+        memset(scratch->stamp, 0, (size_t)scratch->cells * sizeof(uint32_t));
+        scratch->generation = 1;
+    }
+    return scratch->generation;
+}
+
+// Cell one step from cell in the given direction, wrapping around the edges
+static int neighbor_cell(const GameState* game, int cell, Direction dir) {
+    Point p = {cell % game->width, cell / game->width};
+    Point next = step_position(p, dir, game->width, game->height);
+    return next.y * game->width + next.x;
+}
+
+// Count the free cells reachable from start (a free cell), stopping once
+// limit have been found
+static int reachable_area(const GameState* game, AutopilotScratch* scratch, int start, int limit) {
+    uint32_t generation = next_generation(scratch);
+    int* queue = scratch->queue;
+    int head = 0;
+    int tail = 0;
+    
+    scratch->stamp[start] = generation;
+    queue[tail++] = start;
+    while (head < tail && tail < limit) {
+        int cell = queue[head++];
+        for (int d = 0; d < 4; d++) {
+            int next = neighbor_cell(game, cell, (Direction)d);
+            if (scratch->stamp[next] == generation || game->occupied[next]) continue;
+            scratch->stamp[next] = generation;
+            queue[tail++] = next;
+        }
+    }
+    return tail;
+}
+
+// Breadth-first search from the head to the food; returns the first move of a
+// shortest path, or -1 if the body walls the food off
+static int path_to_food(const GameState* game, AutopilotScratch* scratch, int head_cell) {
+    Point food = game->food.position;
+    if (food.x < 0 || food.x >= game->width || food.y < 0 || food.y >= game->height) return -1;
+    int food_cell = food.y * game->width + food.x;
+    
+    uint32_t generation = next_generation(scratch);
+    int* queue = scratch->queue;
+    int head = 0;
+    int tail = 0;
+    
+    scratch->stamp[head_cell] = generation;
+    queue[tail++] = head_cell;
+    while (head < tail) {
+        int cell = queue[head++];
+        for (int d = 0; d < 4; d++) {
+            int next = neighbor_cell(game, cell, (Direction)d);
+            if (scratch->stamp[next] == generation || game->occupied[next]) continue;
+            scratch->stamp[next] = generation;
+            
+            // Every cell remembers the first step of the path that reached it
+            unsigned char first = cell == head_cell ? (unsigned char)d : scratch->first_move[cell];
+            if (next == food_cell) return first;
+            scratch->first_move[next] = first;
+            queue[tail++] = next;
+        }
+    }
+    return -1;
+}
+
+// Pick the direction the snake should move in next
+Direction autopilot_choose_direction(GameState* game, AutopilotScratch* scratch) {
+    Direction fallback = peek_direction(game);
+    if (!game || !game->body || game->game_over || !scratch || !scratch->queue) return fallback;
+    if (game->width * game->height > scratch->cells) return fallback;
+    
+    Point head = game->body[game->snake_head].position;
+    int head_cell = head.y * game->width + head.x;
+    
+    // Follow the shortest path unless its first step closes the snake into a
+    // pocket it cannot fit in
+    int path = path_to_food(game, scratch, head_cell);
+    if (path >= 0) {
+        int next = neighbor_cell(game, head_cell, (Direction)path);
+        if (reachable_area(game, scratch, next, game->snake_length) >= game->snake_length) {
+            return (Direction)path;
+        }
+    }
+    
+    // Otherwise keep as much room as possible, preferring to go straight on ties
+    Direction best = fallback;
+    int best_area = 0;
+    for (int d = 0; d < 4; d++) {
+        int next = neighbor_cell(game, head_cell, (Direction)d);
+        if (game->occupied[next]) continue;
+        int area = reachable_area(game, scratch, next, game->width * game->height);
+        if (area > best_area || (area == best_area && (Direction)d == fallback)) {
+            best_area = area;
+            best = (Direction)d;
+        }
+    }
+    return best;
+}
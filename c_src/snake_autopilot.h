@@ -0,0 +1,51 @@
+#ifndef SNAKE_AUTOPILOT_H
+#define SNAKE_AUTOPILOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "snake_core.h"
+
+// Built-in bot for demos and soak tests. Each call runs a breadth-first search
+// from the head over the wrap-around board, treating body cells as walls, and
+// heads along a shortest path to the food. When there is no such path, or its
+// first step leads into a pocket too small for the snake, it takes the safe
+// move that keeps the largest area reachable instead. All search state lives
+// in a scratch arena set up once per board; cells are marked visited with a
+// generation stamp, so starting a search never clears anything and ticks never
+// allocate.
+
+// Search state over caller-provided storage
+typedef struct {
+    int* queue;         // BFS queue of cells
+    uint32_t* stamp;    // Generation that last visited each cell
+    unsigned char* first_move;  // Direction of the first step on the path to each cell
+    uint32_t generation;  // Stamp of the current search
+    int cells;          // Board cells the arena covers
+} AutopilotScratch;
+
+// Bytes of scratch storage a width x height board needs, or 0 if the
+// dimensions are unsupported
+size_t autopilot_scratch_size(int width, int height);
+
+// Set up scratch on caller storage, which must stay valid while it is used and
+// be aligned for int. It serves any game whose board has at most width x
+// height cells. Returns false if the storage is missing, misaligned or too
+// small.
+bool autopilot_init(AutopilotScratch* scratch, int width, int height,
+                    void* storage, size_t storage_size);
+
+// Pick the direction the snake should move in next; pass it to set_direction
+// before the tick. Returns the direction the next tick would take anyway when
+// every move is fatal or the game or scratch is unusable.
+Direction autopilot_choose_direction(GameState* game, AutopilotScratch* scratch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_AUTOPILOT_H
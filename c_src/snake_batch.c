@@ -0,0 +1,212 @@
+#include "snake_batch.h"
+#include "snake_internal.h"
+#include <stdint.h>
+
+// Start of game index's slice in the per-cell arrays
+static size_t game_offset(const BatchGameState* batch, int index) {
+    return (size_t)index * (size_t)batch->cells;
+}
+
+static void spawn_batch_food(BatchGameState* batch, int index);
+
+// Put game index's snake and food in their starting positions
+static void setup_batch_game(BatchGameState* batch, int index) {
+    size_t offset = game_offset(batch, index);
+    int* body = batch->body + offset;
+    unsigned char* occupied = batch->occupied + offset;
+    int* free_cells = batch->free_cells + offset;
+    int* free_slot = batch->free_slot + offset;
+    
+    // Same starting layout as setup_game: head in the middle, body to its left
+    int start_x = batch->width / 2;
+    int start_y = batch->height / 2;
+    
+    batch->snake_length[index] = INITIAL_SNAKE_LENGTH;
+    batch->snake_head[index] = 0;
+    batch->direction[index] = RIGHT;
+    batch->score[index] = 0;
+    batch->done[index] = 0;
+    batch->head_x[index] = start_x;
+    batch->head_y[index] = start_y;
+    
+    free_list_reset(occupied, free_cells, free_slot, &batch->free_count[index], batch->cells);
+    for (int i = 0; i < INITIAL_SNAKE_LENGTH; i++) {
+        body[i] = start_y * batch->width + (start_x - i);
+        free_list_take(occupied, free_cells, free_slot, &batch->free_count[index], body[i]);
+    }
+    
+    spawn_batch_food(batch, index);
+}
+
+// Place game index's food on a uniformly random free cell, as spawn_food does
+static void spawn_batch_food(BatchGameState* batch, int index) {
+    if (batch->free_count[index] == 0) {
+        batch->food_x[index] = -1;
+        batch->food_y[index] = -1;
+        return;
+    }
+    
+    int* free_cells = batch->free_cells + game_offset(batch, index);
+    int slot = pcg32_below(&batch->rng_state[index], batch->rng_inc[index], batch->free_count[index]);
+    int cell = free_cells[slot];
+    batch->food_x[index] = cell % batch->width;
+    batch->food_y[index] = cell / batch->width;
+}
+
+// Bytes of caller storage needed for count games of width x height
+size_t batch_storage_size(int count, int width, int height) {
+    if (count < 1) return 0;
+    
+    size_t per_game = game_storage_size(width, height);
+    if (per_game == 0) return 0;
+    
+    // Scalars per game: two uint64_t, eight int and two bytes
+    size_t cells = (size_t)width * (size_t)height;
+    size_t scalars = 2 * sizeof(uint64_t) + 8 * sizeof(int) + 2;
+    size_t arrays = cells * (3 * sizeof(int) + sizeof(unsigned char));
+    if ((size_t)count > SIZE_MAX / (scalars + arrays)) return 0;
+    
+    return (size_t)count * (scalars + arrays);
+}
+
+// Carve count elements of the given size off the storage cursor
+static void* take_storage(unsigned char** cursor, size_t count, size_t size) {
+    void* block = *cursor;
+    *cursor += count * size;
+    return block;
+}
+
+// Lay the batch out in caller storage and start every game
+bool batch_init(BatchGameState* batch, int count, int width, int height,
+                void* storage, size_t storage_size) {
+    size_t needed = batch_storage_size(count, width, height);
+    if (!batch || !storage || needed == 0 || storage_size < needed) return false;
+    if ((uintptr_t)storage % sizeof(uint64_t) != 0) return false;
+    
+    size_t games = (size_t)count;
+    size_t cells = (size_t)width * (size_t)height;
+    unsigned char* cursor = (unsigned char*)storage;
+    
+    batch->count = count;
+    batch->width = width;
+    batch->height = height;
+    batch->cells = (int)cells;
+    
+    // Widest types first so every array stays naturally aligned
+    batch->rng_state = take_storage(&cursor, games, sizeof(uint64_t));
+    batch->rng_inc = take_storage(&cursor, games, sizeof(uint64_t));
+    batch->head_x = take_storage(&cursor, games, sizeof(int));
+    batch->head_y = take_storage(&cursor, games, sizeof(int));
+    batch->snake_head = take_storage(&cursor, games, sizeof(int));
+    batch->snake_length = take_storage(&cursor, games, sizeof(int));
+    batch->food_x = take_storage(&cursor, games, sizeof(int));
+    batch->food_y = take_storage(&cursor, games, sizeof(int));
+    batch->score = take_storage(&cursor, games, sizeof(int));
+    batch->free_count = take_storage(&cursor, games, sizeof(int));
+    batch->body = take_storage(&cursor, games * cells, sizeof(int));
+    batch->free_cells = take_storage(&cursor, games * cells, sizeof(int));
+    batch->free_slot = take_storage(&cursor, games * cells, sizeof(int));
+    batch->direction = take_storage(&cursor, games, sizeof(uint8_t));
+    batch->done = take_storage(&cursor, games, sizeof(uint8_t));
+    batch->occupied = take_storage(&cursor, games * cells, sizeof(unsigned char));
+    
+    for (int i = 0; i < count; i++) {
+        snake_auto_seed(&batch->rng_state[i], &batch->rng_inc[i]);
+        setup_batch_game(batch, i);
+    }
+    
+    return true;
+}
+
+// Seed game index's generator and restart it
+void batch_seed_game(BatchGameState* batch, int index, uint64_t seed, uint64_t stream) {
+    if (!batch || index < 0 || index >= batch->count) return;
+    
+    pcg32_seed(&batch->rng_state[index], &batch->rng_inc[index], seed, stream);
+    setup_batch_game(batch, index);
+}
+
+// Restart game index on the same board
+void batch_reset_game(BatchGameState* batch, int index) {
+    if (!batch || index < 0 || index >= batch->count) return;
+    
+    setup_batch_game(batch, index);
+}
+
+// Step games [begin, end) once
+int batch_update_range(BatchGameState* batch, const uint8_t* actions, int begin, int end) {
+    if (!batch) return 0;
+    if (begin < 0) begin = 0;
+    if (end > batch->count) end = batch->count;
+    
+    const int width = batch->width;
+    const int height = batch->height;
+    const int capacity = batch->cells;
+    int running = 0;
+    
+    for (int i = begin; i < end; i++) {
+        if (batch->done[i]) continue;
+        
+        // Apply the action with set_direction's 180-degree rule
+        Direction direction = (Direction)batch->direction[i];
+        if (actions && actions[i] <= LEFT && !is_reversal(direction, (Direction)actions[i])) {
+            direction = (Direction)actions[i];
+            batch->direction[i] = (uint8_t)direction;
+        }
+        
+        size_t offset = game_offset(batch, i);
+        int* body = batch->body + offset;
+        unsigned char* occupied = batch->occupied + offset;
+        int* free_cells = batch->free_cells + offset;
+        int* free_slot = batch->free_slot + offset;
+        
+        Point head = {batch->head_x[i], batch->head_y[i]};
+        Point new_head = step_position(head, direction, width, height);
+        int new_cell = new_head.y * width + new_head.x;
+        
+        // Any occupied cell is body: a move always leaves the head's own cell
+        if (occupied[new_cell]) {
+            batch->done[i] = 1;
+            continue;
+        }
+        
+        bool eaten_food = new_head.x == batch->food_x[i] && new_head.y == batch->food_y[i];
+        bool grew = false;
+        if (eaten_food) {
+            if (batch->snake_length[i] < capacity) {
+                batch->snake_length[i]++;
+                grew = true;
+            }
+            batch->score[i] += FOOD_VALUE;
+        }
+        
+        // The tail leaves its cell unless the snake grew this tick
+        if (!grew) {
+            int tail_slot = batch->snake_head[i] + batch->snake_length[i] - 1;
+            if (tail_slot >= capacity) tail_slot -= capacity;
+            free_list_release(occupied, free_cells, free_slot, &batch->free_count[i], body[tail_slot]);
+        }
+        
+        int head_slot = batch->snake_head[i] == 0 ? capacity - 1 : batch->snake_head[i] - 1;
+        batch->snake_head[i] = head_slot;
+        body[head_slot] = new_cell;
+        free_list_take(occupied, free_cells, free_slot, &batch->free_count[i], new_cell);
+        batch->head_x[i] = new_head.x;
+        batch->head_y[i] = new_head.y;
+        
+        if (eaten_food) {
+            spawn_batch_food(batch, i);
+        }
+        
+        running++;
+    }
+    
+    return running;
+}
+
+// Step every game once
+int batch_update(BatchGameState* batch, const uint8_t* actions) {
+    if (!batch) return 0;
+    
+    return batch_update_range(batch, actions, 0, batch->count);
+}
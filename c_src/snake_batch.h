@@ -0,0 +1,75 @@
+#ifndef SNAKE_BATCH_H
+#define SNAKE_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "snake_core.h"
+
+// Action value that keeps a game's current direction for this step
+#define BATCH_NO_ACTION 0xFF
+
+// Many independent games on boards of the same size, stored as one array per
+// field so a whole batch can be stepped in a single call. Game i plays exactly
+// like a GameState seeded with the same (seed, stream) and given the same
+// directions: the tick, food and 180-degree turn rules are shared.
+// All arrays live in the caller-provided storage passed to batch_init.
+typedef struct {
+    int count;          // Number of games in the batch
+    int width;          // Width of every board
+    int height;         // Height of every board
+    int cells;          // width * height, also the per-game body capacity
+    int* head_x;        // Head column per game
+    int* head_y;        // Head row per game
+    int* snake_head;    // Ring index of the head inside the game's body slice
+    int* snake_length;  // Current length per game
+    uint8_t* direction; // Current Direction per game
+    int* food_x;        // Food column per game (-1 when the board is full)
+    int* food_y;        // Food row per game (-1 when the board is full)
+    int* score;         // Current score per game
+    uint8_t* done;      // 1 once the game is over
+    int* free_count;    // Free cells per game
+    uint64_t* rng_state;  // PCG32 state per game
+    uint64_t* rng_inc;    // PCG32 stream selector per game
+    int* body;          // Body rings of cell indices, cells entries per game
+    unsigned char* occupied;  // Occupancy grids, cells entries per game
+    int* free_cells;    // Free-cell lists, cells entries per game
+    int* free_slot;     // Cell-to-slot maps, cells entries per game
+} BatchGameState;
+
+// Bytes of caller storage needed for count games of width x height, or 0 if
+// the dimensions are unsupported (same limits as game_storage_size)
+size_t batch_storage_size(int count, int width, int height);
+
+// Lay the batch out in caller storage (aligned for uint64_t) and start every
+// game with a time-based seed. No memory is allocated here or while stepping.
+// Returns false if the dimensions are unsupported or the storage is missing,
+// misaligned or too small.
+bool batch_init(BatchGameState* batch, int count, int width, int height,
+                void* storage, size_t storage_size);
+
+// Seed game index's generator and restart it, as seed_game does
+void batch_seed_game(BatchGameState* batch, int index, uint64_t seed, uint64_t stream);
+
+// Restart game index on the same board, as reset_game does
+void batch_reset_game(BatchGameState* batch, int index);
+
+// Step every game once. actions holds one Direction per game, or
+// BATCH_NO_ACTION to keep going straight; it may be NULL. Each action is
+// applied like a single turn queued with set_direction (reversals are ignored).
+// Finished games are left untouched. Returns the number of games still running.
+int batch_update(BatchGameState* batch, const uint8_t* actions);
+
+// Step games [begin, end) only; batch_update is batch_update_range(batch, actions, 0, count)
+// Disjoint ranges touch disjoint memory and may be stepped on different threads.
+int batch_update_range(BatchGameState* batch, const uint8_t* actions, int begin, int end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_BATCH_H
@@ -1,32 +1,88 @@
 #include "snake_core.h"
+#include "snake_internal.h"
+#include "snake_profile.h"
+#include "snake_probes.h"
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <string.h>
 
-// Initialize the random number generator
-static void init_random() {
-    static bool initialized = false;
-    if (!initialized) {
-        srand((unsigned int)time(NULL));
-        initialized = true;
-    }
+// Helper function to get an unbiased random number in [0, bound)
+static int get_random(GameState* game, int bound) {
+    return pcg32_below(&game->rng_state, game->rng_inc, bound);
 }
 
-// Helper function to get a random number within a range
-static int get_random(int min, int max) {
-    return min + rand() % (max - min + 1);
+// Pick a seed for games that were not seeded explicitly; the counter keeps
+// games created within the same second on different streams
+void snake_auto_seed(uint64_t* state, uint64_t* inc) {
+    static atomic_uint_fast64_t games_seeded = 0;
+    uint64_t stream = atomic_fetch_add(&games_seeded, 1);
+    pcg32_seed(state, inc, (uint64_t)time(NULL), stream);
 }
 
-// Initialize the game state with default values
-void initialize_game(GameState* game, int width, int height) {
-    if (!game) return;
+// Map a logical segment index (0 = head) to its slot in the ring buffer
+static int segment_slot(const GameState* game, int index) {
+    int slot = game->snake_head + index;
+    return slot >= game->capacity ? slot - game->capacity : slot;
+}
+
+// Map a board position to its cell in the occupancy grid
+static int cell_index(const GameState* game, Point position) {
+    return position.y * game->width + position.x;
+}
+
+// Check whether a position lies on the board
+static bool in_bounds(const GameState* game, Point position) {
+    return position.x >= 0 && position.x < game->width &&
+           position.y >= 0 && position.y < game->height;
+}
+
+// Remove a cell from the free list and mark it occupied
+static void take_cell(GameState* game, int cell) {
+    free_list_take(game->occupied, game->free_cells, game->free_slot, &game->free_count, cell);
+}
+
+// Return a cell to the free list and mark it empty
+static void release_cell(GameState* game, int cell) {
+    free_list_release(game->occupied, game->free_cells, game->free_slot, &game->free_count, cell);
+}
+
+// Find the first queued turn that is legal from the current direction
+// Rejected turns (reversals and repeats) are skipped; with consume set, they and
+// the applied turn are removed from the queue
+static Direction next_direction(GameState* game, bool consume) {
+    Direction direction = game->direction;
+    int head = game->input_head;
+    int count = game->input_count;
     
-    init_random();
+    while (count > 0) {
+        Direction requested = game->input_queue[head];
+        head = (head + 1) % INPUT_QUEUE_SIZE;
+        count--;
+        if (requested != direction && !is_reversal(direction, requested)) {
+            direction = requested;
+            break;
+        }
+    }
+    
+    if (consume) {
+        game->input_head = head;
+        game->input_count = count;
+    }
+    return direction;
+}
+
+// Put the snake and food in their starting positions on the active storage
+static void setup_game(GameState* game) {
+    int width = game->width;
+    int height = game->height;
     
-    game->width = width;
-    game->height = height;
     game->snake_length = INITIAL_SNAKE_LENGTH;
+    game->snake_head = 0;
     game->direction = RIGHT;
+    game->input_head = 0;
+    game->input_count = 0;
     game->score = 0;
     game->game_over = false;
     
@@ -34,107 +90,260 @@ void initialize_game(GameState* game, int width, int height) {
     int start_x = width / 2;
     int start_y = height / 2;
     
-    // Initialize snake segments
+    // Start with every cell free
+    free_list_reset(game->occupied, game->free_cells, game->free_slot,
+                    &game->free_count, width * height);
+    
+    // Initialize snake segments and take their cells
     for (int i = 0; i < game->snake_length; i++) {
-        game->snake[i].position.x = start_x - i;
-        game->snake[i].position.y = start_y;
+        game->body[i].position.x = start_x - i;
+        game->body[i].position.y = start_y;
+        take_cell(game, cell_index(game, game->body[i].position));
     }
     
     // Spawn initial food
     spawn_food(game);
 }
 
-// Generate a new point in the given direction from the current position
-static Point get_new_position(Point current, Direction dir, int width, int height) {
-    Point new_pos = current;
+// Point the game at its embedded arrays
+static void use_embedded_arrays(GameState* game) {
+    game->body = game->snake;
+    game->occupied = game->occupied_storage;
+    game->free_cells = game->free_cells_storage;
+    game->free_slot = game->free_slot_storage;
+}
+
+// Point the game into caller storage for cells cells, laid out as counted by
+// game_storage_size: body ring, free list, slot map, then occupancy grid
+static void use_storage(GameState* game, void* storage, size_t cells) {
+    unsigned char* cursor = (unsigned char*)storage;
+    game->body = (SnakeSegment*)cursor;
+    cursor += cells * sizeof(SnakeSegment);
+    game->free_cells = (int*)cursor;
+    cursor += cells * sizeof(int);
+    game->free_slot = (int*)cursor;
+    cursor += cells * sizeof(int);
+    game->occupied = cursor;
+}
+
+// Initialize the game state with default values
+void initialize_game(GameState* game, int width, int height) {
+    if (!game) return;
     
-    switch (dir) {
-        case UP:
-            new_pos.y = (new_pos.y - 1 + height) % height;  // Wrap around top/bottom
-            break;
-        case RIGHT:
-            new_pos.x = (new_pos.x + 1) % width;  // Wrap around right edge
-            break;
-        case DOWN:
-            new_pos.y = (new_pos.y + 1) % height;  // Wrap around bottom
-            break;
-        case LEFT:
-            new_pos.x = (new_pos.x - 1 + width) % width;  // Wrap around left edge
-            break;
+    // Keep the board within what the occupancy grid can represent
+    if (width < MIN_BOARD_WIDTH) width = MIN_BOARD_WIDTH;
+    if (width > MAX_BOARD_WIDTH) width = MAX_BOARD_WIDTH;
+    if (height < MIN_BOARD_HEIGHT) height = MIN_BOARD_HEIGHT;
+    if (height > MAX_BOARD_HEIGHT) height = MAX_BOARD_HEIGHT;
+    
+    game->width = width;
+    game->height = height;
+    
+    // Use the embedded arrays, which cap the snake at MAX_SNAKE_LENGTH
+    game->capacity = MAX_SNAKE_LENGTH;
+    use_embedded_arrays(game);
+    
+    snake_auto_seed(&game->rng_state, &game->rng_inc);
+    setup_game(game);
+}
+
+// Seed the game's random generator and restart the game from it
+void seed_game(GameState* game, uint64_t seed, uint64_t stream) {
+    if (!game || !game->body) return;
+    
+    pcg32_seed(&game->rng_state, &game->rng_inc, seed, stream);
+    setup_game(game);
+}
+
+// Bytes of caller storage needed for a width x height board
+size_t game_storage_size(int width, int height) {
+    if (width < MIN_BOARD_WIDTH || height < MIN_BOARD_HEIGHT) return 0;
+    if (width > MAX_STORAGE_CELLS / height) return 0;
+    
+    // Body ring, free list and slot map, then the byte-sized occupancy grid
+    size_t cells = (size_t)width * (size_t)height;
+    return cells * (sizeof(SnakeSegment) + 2 * sizeof(int) + sizeof(unsigned char));
+}
+
+// Initialize the game on caller-provided storage sized for the whole board
+bool initialize_game_with_storage(GameState* game, int width, int height,
+                                  void* storage, size_t storage_size) {
+    size_t needed = game_storage_size(width, height);
+    if (!game || !storage || needed == 0 || storage_size < needed) return false;
+    if ((uintptr_t)storage % sizeof(int) != 0) return false;
+    
+    size_t cells = (size_t)width * (size_t)height;
+    game->width = width;
+    game->height = height;
+    game->capacity = (int)cells;
+    use_storage(game, storage, cells);
+    
+    snake_auto_seed(&game->rng_state, &game->rng_inc);
+    setup_game(game);
+    return true;
+}
+
+// Copy src into dst, pointing dst at its own arrays
+bool clone_game(GameState* dst, const GameState* src, void* storage, size_t storage_size) {
+    if (!dst || !src || !src->body || dst == src) return false;
+    
+    if (src->body == src->snake) {
+        memcpy(dst, src, sizeof(GameState));
+        use_embedded_arrays(dst);
+        return true;
     }
     
-    return new_pos;
+    // src->body starts the storage block the other arrays follow in
+    size_t needed = game_storage_size(src->width, src->height);
+    if (!storage || storage_size < needed || (uintptr_t)storage % sizeof(int) != 0) return false;
+    
+    memcpy(dst, src, sizeof(GameState));
+    memcpy(storage, src->body, needed);
+    use_storage(dst, storage, (size_t)src->width * (size_t)src->height);
+    return true;
 }
 
 // Process a single game tick, moving the snake and handling collisions
 bool update_game(GameState* game) {
-    if (!game || game->game_over) return false;
+    return update_game_ex(game, NULL);
+}
+
+// Process a single game tick and describe what changed (update_game_ex without
+// the profiling hooks)
+static bool tick_game(GameState* game, TickDelta* out) {
+    TickDelta delta = {
+        .moved = false,
+        .new_head = {-1, -1},
+        .vacated_tail = {-1, -1},
+        .old_food = {-1, -1},
+        .new_food = {-1, -1},
+        .ate_food = false,
+        .score_delta = 0,
+        .wrapped = false,
+        .death = DEATH_NONE
+    };
+    
+    if (!game || game->game_over) {
+        if (out) *out = delta;
+        return false;
+    }
+    
+    delta.old_food = game->food.position;
+    delta.new_food = game->food.position;
+    
+    // Apply the next queued turn, if any is legal
+    game->direction = next_direction(game, true);
     
     // Calculate new head position
-    Point new_head = get_new_position(
-        game->snake[0].position,
-        game->direction,
-        game->width,
-        game->height
-    );
+    Point head = game->body[game->snake_head].position;
+    Point new_head = step_position(head, game->direction, game->width, game->height);
     
     // Check for collision with self
     if (check_self_collision(game, new_head)) {
         game->game_over = true;
+        delta.death = DEATH_SELF_COLLISION;
+        SNAKE_PROBE4(death, game, game->snake_length, game->score, DEATH_SELF_COLLISION);
+        if (out) *out = delta;
         return true;
     }
     
     // Check if snake eats food
     bool eaten_food = is_food_position(game, new_head);
     
-    // If snake eats food, increase length and spawn new food
+    // If snake eats food, increase length (the tail stays where it is)
+    bool grew = false;
     if (eaten_food) {
-        if (game->snake_length < MAX_SNAKE_LENGTH) {
+        if (game->snake_length < game->capacity) {
             game->snake_length++;
+            grew = true;
         }
         game->score += game->food.value;
-        spawn_food(game);
+        delta.score_delta = game->food.value;
     }
     
-    // Move snake body (from tail to head)
-    for (int i = game->snake_length - 1; i > 0; i--) {
-        game->snake[i].position = game->snake[i - 1].position;
+    // The tail leaves its cell unless the snake grew this tick
+    if (!grew) {
+        Point tail = game->body[segment_slot(game, game->snake_length - 1)].position;
+        release_cell(game, cell_index(game, tail));
+        delta.vacated_tail = tail;
     }
     
-    // Update head position
-    game->snake[0].position = new_head;
+    // Move the head one slot back in the ring; the old tail slot drops out of
+    // range by itself when the snake did not grow, so no segment is copied
+    game->snake_head = game->snake_head == 0 ? game->capacity - 1 : game->snake_head - 1;
+    game->body[game->snake_head].position = new_head;
+    take_cell(game, cell_index(game, new_head));
+    
+    // Spawn new food once the body is in its final position
+    if (eaten_food) {
+        spawn_food(game);
+    }
+    
+    if (out) {
+        delta.moved = true;
+        delta.new_head = new_head;
+        delta.new_food = game->food.position;
+        delta.ate_food = eaten_food;
+        delta.wrapped = (game->direction == UP && head.y == 0) ||
+                        (game->direction == DOWN && head.y == game->height - 1) ||
+                        (game->direction == LEFT && head.x == 0) ||
+                        (game->direction == RIGHT && head.x == game->width - 1);
+        *out = delta;
+    }
     
     return true;
 }
 
-// Change the snake's direction (prevents 180-degree turns)
+// Process a single game tick and describe what changed
+bool update_game_ex(GameState* game, TickDelta* out) {
+    SNAKE_PROBE1(tick_start, game);
+    PROFILE_BEGIN(PROFILE_UPDATE_GAME);
+    bool changed = tick_game(game, out);
+    PROFILE_END(PROFILE_UPDATE_GAME);
+    SNAKE_PROBE4(tick_done, game, changed, game ? game->snake_length : 0, game ? game->score : 0);
+    return changed;
+}
+
+// Queue a change of direction for an upcoming tick
 void set_direction(GameState* game, Direction new_direction) {
-    if (!game) return;
+    if (!game || (unsigned)new_direction > LEFT) return;
     
-    // Prevent 180-degree turns (can't go directly opposite current direction)
-    if ((game->direction == UP && new_direction == DOWN) ||
-        (game->direction == DOWN && new_direction == UP) ||
-        (game->direction == LEFT && new_direction == RIGHT) ||
-        (game->direction == RIGHT && new_direction == LEFT)) {
-        return;
+    // Holding a key repeats the same turn; keep only the first one
+    Direction last = game->direction;
+    if (game->input_count > 0) {
+        last = game->input_queue[(game->input_head + game->input_count - 1) % INPUT_QUEUE_SIZE];
     }
+    if (new_direction == last || game->input_count == INPUT_QUEUE_SIZE) return;
     
-    game->direction = new_direction;
+    game->input_queue[(game->input_head + game->input_count) % INPUT_QUEUE_SIZE] = new_direction;
+    game->input_count++;
 }
 
-// Check for collision with snake's own body
-bool check_self_collision(GameState* game, Point position) {
-    if (!game) return false;
+// Direction the next tick will move in, taking queued turns into account
+Direction peek_direction(GameState* game) {
+    if (!game) return RIGHT;
     
-    // Start from index 1 (skip head) to check if new position collides with body
-    for (int i = 1; i < game->snake_length; i++) {
-        if (game->snake[i].position.x == position.x && 
-            game->snake[i].position.y == position.y) {
-            return true;
-        }
-    }
+    return next_direction(game, false);
+}
+
+// Check for collision with snake's own body (check_self_collision without the
+// profiling hooks)
+static bool hits_body(GameState* game, Point position) {
+    if (!game || !in_bounds(game, position)) return false;
+    
+    // Any occupied cell other than the head's own cell is part of the body
+    Point head = game->body[game->snake_head].position;
+    if (position.x == head.x && position.y == head.y) return false;
     
-    return false;
+    return game->occupied[cell_index(game, position)] != 0;
+}
+
+// Check for collision with snake's own body
+bool check_self_collision(GameState* game, Point position) {
+    PROFILE_BEGIN(PROFILE_CHECK_SELF_COLLISION);
+    bool hit = hits_body(game, position);
+    PROFILE_END(PROFILE_CHECK_SELF_COLLISION);
+    return hit;
 }
 
 // Check if position is on food
@@ -145,61 +354,34 @@ bool is_food_position(GameState* game, Point position) {
             game->food.position.y == position.y);
 }
 
-// Generate new food at a random valid position (not on snake)
-void spawn_food(GameState* game) {
+// Generate new food at a random valid position (spawn_food without the
+// profiling hooks)
+static void place_food(GameState* game) {
     if (!game) return;
     
-    // Maximum attempts to find a valid position
-    const int MAX_ATTEMPTS = 100;
-    Point position;
-    bool valid_position = false;
-    int attempts = 0;
-    
-    while (!valid_position && attempts < MAX_ATTEMPTS) {
-        position.x = get_random(0, game->width - 1);
-        position.y = get_random(0, game->height - 1);
-        
-        valid_position = true;
-        
-        // Check if position overlaps with any snake segment
-        for (int i = 0; i < game->snake_length; i++) {
-            if (game->snake[i].position.x == position.x && 
-                game->snake[i].position.y == position.y) {
-                valid_position = false;
-                break;
-            }
-        }
-        
-        attempts++;
-    }
+    game->food.value = FOOD_VALUE;
     
-    // If we failed to find a valid position after max attempts, find any free cell
-    if (!valid_position) {
-        for (int y = 0; y < game->height; y++) {
-            for (int x = 0; x < game->width; x++) {
-                position.x = x;
-                position.y = y;
-                
-                valid_position = true;
-                for (int i = 0; i < game->snake_length; i++) {
-                    if (game->snake[i].position.x == x && 
-                        game->snake[i].position.y == y) {
-                        valid_position = false;
-                        break;
-                    }
-                }
-                
-                if (valid_position) {
-                    game->food.position = position;
-                    game->food.value = 10;  // Default food value
-                    return;
-                }
-            }
-        }
-    } else {
-        game->food.position = position;
-        game->food.value = 10;  // Default food value
+    // No free cell left: park the food off the board
+    if (game->free_count == 0) {
+        PROFILE_EVENT(PROFILE_SPAWN_BOARD_FULL);
+        SNAKE_PROBE4(spawn, game, -1, 0, 1);
+        game->food.position.x = -1;
+        game->food.position.y = -1;
+        return;
     }
+    
+    // Every entry in the free range is a valid spot, so one draw suffices
+    int cell = game->free_cells[get_random(game, game->free_count)];
+    SNAKE_PROBE4(spawn, game, cell, game->free_count, 0);
+    game->food.position.x = cell % game->width;
+    game->food.position.y = cell / game->width;
+}
+
+// Generate new food at a random valid position (not on snake)
+void spawn_food(GameState* game) {
+    PROFILE_BEGIN(PROFILE_SPAWN_FOOD);
+    place_food(game);
+    PROFILE_END(PROFILE_SPAWN_FOOD);
 }
 
 // Get snake segment at index
@@ -207,7 +389,28 @@ Point get_snake_segment(GameState* game, int index) {
     Point empty = {-1, -1};
     if (!game || index < 0 || index >= game->snake_length) return empty;
     
-    return game->snake[index].position;
+    return game->body[segment_slot(game, index)].position;
+}
+
+// Copy up to max segments, head first, into out
+int copy_snake_segments(GameState* game, Point* out, int max) {
+    if (!game || !out || max <= 0) return 0;
+    
+    int count = game->snake_length < max ? game->snake_length : max;
+    
+    // The ring holds the snake in at most two runs: head to buffer end, then from slot 0
+    int first_run = game->capacity - game->snake_head;
+    if (first_run > count) first_run = count;
+    
+    const SnakeSegment* run = game->body + game->snake_head;
+    for (int i = 0; i < first_run; i++) {
+        out[i] = run[i].position;
+    }
+    for (int i = first_run; i < count; i++) {
+        out[i] = game->body[i - first_run].position;
+    }
+    
+    return count;
 }
 
 // Get food position
@@ -234,12 +437,10 @@ bool is_game_over(GameState* game) {
 
 // Reset the game to initial state
 void reset_game(GameState* game) {
-    if (!game) return;
+    if (!game || !game->body) return;
     
-    int width = game->width;
-    int height = game->height;
-    
-    // Re-initialize the game with the same dimensions
-    initialize_game(game, width, height);
+    // Start over on the same board and storage; the generator keeps running so
+    // a seeded sequence of games stays reproducible
+    SNAKE_PROBE3(reset, game, game->snake_length, game->score);
+    setup_game(game);
 }
-
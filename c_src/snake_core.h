@@ -6,10 +6,19 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // Constants for game dimensions and settings
-#define MAX_SNAKE_LENGTH 100  // Maximum length the snake can grow to
+#define MAX_SNAKE_LENGTH 100  // Maximum length the snake can grow to (embedded storage only)
 #define INITIAL_SNAKE_LENGTH 3  // Starting length of snake
+#define MIN_BOARD_WIDTH (2 * (INITIAL_SNAKE_LENGTH - 1))  // Smallest board width (the starting body fits left of centre)
+#define MIN_BOARD_HEIGHT 2  // Smallest board height (a move always changes the head cell)
+#define MAX_BOARD_WIDTH 64  // Largest board width the occupancy grid can hold
+#define MAX_BOARD_HEIGHT 64  // Largest board height the occupancy grid can hold
+#define MAX_BOARD_CELLS (MAX_BOARD_WIDTH * MAX_BOARD_HEIGHT)
+#define MAX_STORAGE_CELLS (1 << 24)  // Largest board (in cells) accepted with caller storage
+#define INPUT_QUEUE_SIZE 4  // Turns that can be queued ahead of the ticks that apply them
 
 // Directions for snake movement
 typedef enum {
@@ -36,35 +45,117 @@ typedef struct {
     int value;  // Score value of the food
 } Food;
 
+// Why a game ended
+typedef enum {
+    DEATH_NONE = 0,           // Still alive
+    DEATH_SELF_COLLISION = 1  // Head ran into the body
+} DeathCause;
+
+// What a single tick changed, for incremental renderers, delta networking and
+// replays. Cells that do not apply are reported as (-1, -1).
+typedef struct {
+    bool moved;         // True if the snake advanced this tick
+    Point new_head;     // Cell the head entered
+    Point vacated_tail; // Cell the tail left, or (-1, -1) when the snake grew
+    Point old_food;     // Food position before the tick
+    Point new_food;     // Food position after the tick (same as old_food unless eaten)
+    bool ate_food;      // True if the head reached the food
+    int score_delta;    // Points gained this tick
+    bool wrapped;       // True if the head crossed a board edge
+    DeathCause death;   // Set on the tick the game ends
+} TickDelta;
+
 // Structure to hold the entire game state
+// The embedded arrays are the compatibility layout used by initialize_game; the
+// pointers below refer either to them or to storage passed to
+// initialize_game_with_storage, and all game logic goes through the pointers.
+// Do not copy a GameState by value (assignment, memcpy, ctypes copies): the
+// copy keeps pointing at the original's arrays, and the two games then
+// overwrite each other. Use clone_game for a second live game, or
+// snapshot_game / restore_game (snake_snapshot.h) to save and roll back state.
 typedef struct {
     int width;          // Width of game board
     int height;         // Height of game board
-    SnakeSegment snake[MAX_SNAKE_LENGTH];  // Array of snake segments
+    SnakeSegment snake[MAX_SNAKE_LENGTH];  // Embedded ring buffer storage
+    int snake_head;     // Ring index of the head segment (tail follows at +length-1)
     int snake_length;   // Current length of the snake
-    Direction direction;  // Current direction of movement
+    Direction direction;  // Direction applied by the last tick
     Food food;          // Current food item
     int score;          // Current score
     bool game_over;     // Game over flag
+    unsigned char occupied_storage[MAX_BOARD_CELLS];  // Embedded occupancy grid
+    int free_cells_storage[MAX_BOARD_CELLS];  // Embedded free-cell list
+    int free_slot_storage[MAX_BOARD_CELLS];   // Embedded cell-to-slot map
+    int free_count;     // Number of cells not covered by the snake
+    int capacity;       // Ring capacity, i.e. the longest the snake can grow
+    SnakeSegment* body;      // Active ring buffer of snake segments
+    unsigned char* occupied; // 1 where a snake segment covers the cell (row-major)
+    int* free_cells;    // Dense list of free cells in [0, free_count), occupied cells after it
+    int* free_slot;     // Position of each cell inside free_cells
+    uint64_t rng_state; // Per-game PCG32 generator state
+    uint64_t rng_inc;   // PCG32 stream selector (always odd)
+    Direction input_queue[INPUT_QUEUE_SIZE];  // Ring of turns waiting for a tick
+    int input_head;     // Ring index of the oldest queued turn
+    int input_count;    // Number of queued turns
 } GameState;
 
 // Function declarations
 
 // Initialize the game state with default values
+// Width is clamped to [MIN_BOARD_WIDTH, MAX_BOARD_WIDTH], height to [MIN_BOARD_HEIGHT, MAX_BOARD_HEIGHT]
 void initialize_game(GameState* game, int width, int height);
 
+// Seed the game's own random generator and restart the game from it, so food
+// placement is reproducible for a given (seed, stream) pair. Games never share
+// generator state, so different games can be stepped on different threads.
+// initialize_game and initialize_game_with_storage pick a time-based seed.
+void seed_game(GameState* game, uint64_t seed, uint64_t stream);
+
+// Bytes of caller storage needed for a width x height board, or 0 if the
+// dimensions are unsupported: narrower than MIN_BOARD_WIDTH, shorter than
+// MIN_BOARD_HEIGHT or larger than MAX_STORAGE_CELLS cells
+size_t game_storage_size(int width, int height);
+
+// Initialize the game on caller-provided storage sized for the whole board, so
+// the snake can grow until it fills every cell. The storage must stay valid for
+// the lifetime of the game and be aligned for int; no memory is allocated here
+// or during ticks. Returns false (leaving the game untouched) if the dimensions
+// are unsupported or the storage is missing, misaligned or smaller than
+// game_storage_size(width, height).
+bool initialize_game_with_storage(GameState* game, int width, int height,
+                                  void* storage, size_t storage_size);
+
+// Make dst an independent copy of src that goes on to play identically. A game
+// on the embedded arrays is copied into dst's own; a game on caller storage
+// needs storage of game_storage_size(src->width, src->height) bytes for dst,
+// with the same requirements as initialize_game_with_storage (storage is
+// ignored otherwise). Returns false, leaving dst untouched, if src is not
+// initialized, dst is src, or the storage is missing, misaligned or too small.
+bool clone_game(GameState* dst, const GameState* src, void* storage, size_t storage_size);
+
 // Process a single game tick, moving the snake and handling collisions
 // Returns true if game state changed, false otherwise
 bool update_game(GameState* game);
 
-// Change the snake's direction
+// Same as update_game, additionally describing the tick in *out (may be NULL)
+// A call that does nothing (game already over) reports moved = false and DEATH_NONE
+bool update_game_ex(GameState* game, TickDelta* out);
+
+// Queue a change of direction for an upcoming tick
+// Each tick takes queued turns in order until one is legal from the direction
+// it actually moves in (no 180-degree turns, no repeats), so quick presses
+// within one tick are applied on consecutive ticks instead of being lost.
+// Turns beyond INPUT_QUEUE_SIZE, or repeating the last queued one, are ignored.
 void set_direction(GameState* game, Direction new_direction);
 
+// Direction the next tick will move in, taking queued turns into account
+Direction peek_direction(GameState* game);
+
 // Check if the movement would cause a collision
 // Returns true if collision detected, false otherwise
 bool check_collision(GameState* game, Point position);
 
-// Check for collision with snake's own body
+// Check for collision with snake's own body (O(1) lookup in the occupancy grid)
 // Returns true if collision detected, false otherwise
 bool check_self_collision(GameState* game, Point position);
 
@@ -72,12 +163,17 @@ bool check_self_collision(GameState* game, Point position);
 // Returns true if position matches food position
 bool is_food_position(GameState* game, Point position);
 
-// Generate new food at a random valid position
+// Generate new food at a uniformly random free cell with a single draw
+// If the snake covers the whole board, the food is parked at (-1, -1)
 void spawn_food(GameState* game);
 
-// Get snake segment at index
+// Get snake segment at index (0 = head, snake_length - 1 = tail)
 Point get_snake_segment(GameState* game, int index);
 
+// Copy up to max segments, head first, into out with a single call
+// Returns the number of segments copied
+int copy_snake_segments(GameState* game, Point* out, int max);
+
 // Get food position
 Point get_food_position(GameState* game);
 
@@ -87,7 +183,7 @@ int get_score(GameState* game);
 // Check if game is over
 bool is_game_over(GameState* game);
 
-// Reset the game to initial state
+// Reset the game to initial state (keeps the game's storage and board size)
 void reset_game(GameState* game);
 
 #ifdef __cplusplus
@@ -0,0 +1,123 @@
+#ifndef SNAKE_INTERNAL_H
+#define SNAKE_INTERNAL_H
+
+// Helpers shared by the single-game core and the batch engine. Keeping the
+// generator, free-list and movement rules in one place is what guarantees that
+// a batched game plays out exactly like the same game on a GameState.
+// Not part of the public API.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "snake_core.h"
+
+#define FOOD_VALUE 10  // Score value of every food item
+
+// Advance a PCG32 generator (XSH RR output)
+static inline uint32_t pcg32_next(uint64_t* state, uint64_t inc) {
+    uint64_t old_state = *state;
+    *state = old_state * 6364136223846793005ULL + inc;
+    uint32_t xorshifted = (uint32_t)(((old_state >> 18) ^ old_state) >> 27);
+    uint32_t rot = (uint32_t)(old_state >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+// Set a generator to a (seed, stream) pair as in the reference PCG32 seeding
+static inline void pcg32_seed(uint64_t* state, uint64_t* inc, uint64_t seed, uint64_t stream) {
+    *state = 0;
+    *inc = (stream << 1) | 1;
+    pcg32_next(state, *inc);
+    *state += seed;
+    pcg32_next(state, *inc);
+}
+
+// Get an unbiased random number in [0, bound)
+// Uses Lemire's multiply-shift with rejection, which rarely needs a division
+static inline int pcg32_below(uint64_t* state, uint64_t inc, int bound) {
+    uint32_t range = (uint32_t)bound;
+    uint64_t product = (uint64_t)pcg32_next(state, inc) * range;
+    uint32_t low = (uint32_t)product;
+    if (low < range) {
+        uint32_t threshold = -range % range;
+        while (low < threshold) {
+            product = (uint64_t)pcg32_next(state, inc) * range;
+            low = (uint32_t)product;
+        }
+    }
+    return (int)(product >> 32);
+}
+
+// Seed a generator for a game that was not seeded explicitly (snake_core.c)
+void snake_auto_seed(uint64_t* state, uint64_t* inc);
+
+// Remove a cell from the free list by swapping it just past the free range
+static inline void free_list_take(unsigned char* occupied, int* free_cells, int* free_slot,
+                                  int* free_count, int cell) {
+    int slot = free_slot[cell];
+    int last = *free_count - 1;
+    int moved = free_cells[last];
+    
+    free_cells[slot] = moved;
+    free_slot[moved] = slot;
+    free_cells[last] = cell;
+    free_slot[cell] = last;
+    (*free_count)--;
+    occupied[cell] = 1;
+}
+
+// Return a cell to the free list by swapping it to the end of the free range
+static inline void free_list_release(unsigned char* occupied, int* free_cells, int* free_slot,
+                                     int* free_count, int cell) {
+    int slot = free_slot[cell];
+    int first = *free_count;
+    int moved = free_cells[first];
+    
+    free_cells[slot] = moved;
+    free_slot[moved] = slot;
+    free_cells[first] = cell;
+    free_slot[cell] = first;
+    (*free_count)++;
+    occupied[cell] = 0;
+}
+
+// Mark every cell of a board free
+static inline void free_list_reset(unsigned char* occupied, int* free_cells, int* free_slot,
+                                   int* free_count, int cells) {
+    for (int i = 0; i < cells; i++) {
+        occupied[i] = 0;
+        free_cells[i] = i;
+        free_slot[i] = i;
+    }
+    *free_count = cells;
+}
+
+// Generate a new point in the given direction, wrapping around the board edges
+static inline Point step_position(Point current, Direction dir, int width, int height) {
+    Point new_pos = current;
+    
+    switch (dir) {
+        case UP:
+            new_pos.y = (new_pos.y - 1 + height) % height;  // Wrap around top/bottom
+            break;
+        case RIGHT:
+            new_pos.x = (new_pos.x + 1) % width;  // Wrap around right edge
+            break;
+        case DOWN:
+            new_pos.y = (new_pos.y + 1) % height;  // Wrap around bottom
+            break;
+        case LEFT:
+            new_pos.x = (new_pos.x - 1 + width) % width;  // Wrap around left edge
+            break;
+    }
+    
+    return new_pos;
+}
+
+// Check whether turning from one direction to another is a 180-degree turn
+static inline bool is_reversal(Direction current, Direction requested) {
+    return (current == UP && requested == DOWN) ||
+           (current == DOWN && requested == UP) ||
+           (current == LEFT && requested == RIGHT) ||
+           (current == RIGHT && requested == LEFT);
+}
+
+#endif // SNAKE_INTERNAL_H
@@ -0,0 +1,150 @@
+#include "snake_journal.h"
+#include "snake_internal.h"
+
+// Map a logical segment index (0 = head) to its slot in the ring buffer
+static int segment_slot(const GameState* game, int index) {
+    int slot = game->snake_head + index;
+    return slot >= game->capacity ? slot - game->capacity : slot;
+}
+
+// Swap two entries of the free-cell list, keeping the slot map in step
+// free_list_take and free_list_release are each a single such swap plus a
+// count change, so the same swap reverses them
+static void swap_free_slots(GameState* game, int a, int b) {
+    int cell_a = game->free_cells[a];
+    int cell_b = game->free_cells[b];
+    game->free_cells[a] = cell_b;
+    game->free_slot[cell_b] = a;
+    game->free_cells[b] = cell_a;
+    game->free_slot[cell_a] = b;
+}
+
+// Bytes of storage a journal holding ticks records needs
+size_t journal_storage_size(int ticks) {
+    if (ticks <= 0) return 0;
+    
+    return (size_t)ticks * sizeof(TickRecord);
+}
+
+// Set up an empty journal on caller storage
+bool journal_init(TickJournal* journal, void* storage, size_t storage_size) {
+    if (!journal || !storage || (uintptr_t)storage % _Alignof(TickRecord) != 0) return false;
+    
+    size_t ticks = storage_size / sizeof(TickRecord);
+    if (ticks == 0) return false;
+    if (ticks > INT32_MAX) ticks = INT32_MAX;
+    
+    journal->records = (TickRecord*)storage;
+    journal->capacity = (int)ticks;
+    journal_clear(journal);
+    return true;
+}
+
+// Forget every record
+void journal_clear(TickJournal* journal) {
+    if (!journal) return;
+    
+    journal->start = 0;
+    journal->count = 0;
+}
+
+// Same as update_game_ex, recording the tick in the journal first
+bool journal_update_game(TickJournal* journal, GameState* game, TickDelta* out) {
+    if (!journal || !journal->records || !game || game->game_over) {
+        return update_game_ex(game, out);
+    }
+    
+    // Claim the next slot, dropping the oldest record when the ring is full
+    int index = journal->start + journal->count;
+    if (index >= journal->capacity) index -= journal->capacity;
+    if (journal->count == journal->capacity) {
+        journal->start = journal->start + 1 == journal->capacity ? 0 : journal->start + 1;
+    } else {
+        journal->count++;
+    }
+    TickRecord* record = &journal->records[index];
+    
+    record->rng_state = game->rng_state;
+    record->food = game->food.position;
+    record->score = game->score;
+    record->direction = (uint8_t)game->direction;
+    for (int i = 0; i < INPUT_QUEUE_SIZE; i++) {
+        record->input_queue[i] = (uint8_t)game->input_queue[i];
+    }
+    record->input_head = (uint8_t)game->input_head;
+    record->input_count = (uint8_t)game->input_count;
+    
+    // The tick will release the tail cell and take the cell ahead of the head;
+    // their free-list slots are what the swaps moved them away from
+    Point tail = game->body[segment_slot(game, game->snake_length - 1)].position;
+    int tail_cell = tail.y * game->width + tail.x;
+    Point head = step_position(game->body[game->snake_head].position, peek_direction(game),
+                               game->width, game->height);
+    record->tail_cell = tail_cell;
+    record->tail_slot = game->free_slot[tail_cell];
+    record->head_slot = game->free_slot[head.y * game->width + head.x];
+    
+    int length = game->snake_length;
+    update_game_ex(game, out);
+    if (game->game_over) {
+        record->outcome = JOURNAL_DIED;
+        record->tail_cell = -1;
+    } else if (game->snake_length > length) {
+        record->outcome = JOURNAL_GREW;
+        record->tail_cell = -1;
+    } else {
+        record->outcome = JOURNAL_MOVED;
+    }
+    
+    return true;
+}
+
+// Undo the most recent recorded tick
+bool undo_tick(TickJournal* journal, GameState* game) {
+    if (!journal || !game || !game->body || journal->count == 0) return false;
+    
+    journal->count--;
+    int index = journal->start + journal->count;
+    if (index >= journal->capacity) index -= journal->capacity;
+    const TickRecord* record = &journal->records[index];
+    
+    if (record->outcome != JOURNAL_DIED) {
+        // Give the head cell back: it sits just past the free range, where
+        // free_list_take swapped it from its old slot
+        int head_cell = game->free_cells[game->free_count];
+        swap_free_slots(game, record->head_slot, game->free_count);
+        game->free_count++;
+        game->occupied[head_cell] = 0;
+        
+        // Step the head forward in the ring again
+        game->snake_head = game->snake_head + 1 == game->capacity ? 0 : game->snake_head + 1;
+        
+        if (record->outcome == JOURNAL_GREW) {
+            game->snake_length--;
+        } else {
+            // Take the tail cell back from the end of the free range; its ring
+            // slot was reused by the head only when the ring was full
+            int tail_cell = record->tail_cell;
+            game->free_count--;
+            swap_free_slots(game, record->tail_slot, game->free_count);
+            game->occupied[tail_cell] = 1;
+            Point* tail = &game->body[segment_slot(game, game->snake_length - 1)].position;
+            tail->x = tail_cell % game->width;
+            tail->y = tail_cell / game->width;
+        }
+    }
+    
+    game->rng_state = record->rng_state;
+    game->food.position = record->food;
+    game->food.value = FOOD_VALUE;
+    game->score = record->score;
+    game->direction = (Direction)record->direction;
+    for (int i = 0; i < INPUT_QUEUE_SIZE; i++) {
+        game->input_queue[i] = (Direction)record->input_queue[i];
+    }
+    game->input_head = record->input_head;
+    game->input_count = record->input_count;
+    game->game_over = false;
+    
+    return true;
+}
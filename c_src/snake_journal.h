@@ -0,0 +1,75 @@
+#ifndef SNAKE_JOURNAL_H
+#define SNAKE_JOURNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "snake_core.h"
+
+// Reversible tick journal for stepping a game backward. Each tick played
+// through journal_update_game leaves one fixed-size record of what the tick
+// overwrote (the cell the tail left, the free-list slots of the cells that
+// changed hands, food, score, generator state, direction and input queue), so
+// undo_tick puts the game back exactly as it was before the tick in O(1),
+// including the free-cell order that decides where future food lands. The
+// journal is a ring over caller storage: once full, each new tick drops the
+// oldest record, so it always covers the most recent ticks.
+
+// What one tick changed, enough to reverse it
+typedef struct {
+    uint64_t rng_state;   // Generator state before the tick
+    Point food;           // Food position before the tick
+    int score;            // Score before the tick
+    int tail_cell;        // Cell the tail left, or -1 when the snake grew or died
+    int tail_slot;        // Free-list slot the tail cell held before the tick
+    int head_slot;        // Free-list slot the new head cell held before the tick
+    uint8_t direction;    // Direction before the tick
+    uint8_t input_queue[INPUT_QUEUE_SIZE];  // Queued turns before the tick
+    uint8_t input_head;
+    uint8_t input_count;
+    uint8_t outcome;      // JOURNAL_MOVED, JOURNAL_GREW or JOURNAL_DIED
+} TickRecord;
+
+#define JOURNAL_MOVED 0  // The snake advanced without growing
+#define JOURNAL_GREW 1   // The snake advanced and grew by one segment
+#define JOURNAL_DIED 2   // The tick ended the game; the snake did not move
+
+// Ring of tick records over caller-provided storage; never allocates
+typedef struct {
+    TickRecord* records;  // Record storage
+    int capacity;       // Ticks the journal can hold
+    int start;          // Ring index of the oldest record
+    int count;          // Records held
+} TickJournal;
+
+// Bytes of storage a journal holding ticks records needs
+size_t journal_storage_size(int ticks);
+
+// Set up an empty journal on caller storage, which must stay valid while the
+// journal is used and be aligned for uint64_t. Returns false if the storage is
+// missing, misaligned or too small for a single record.
+bool journal_init(TickJournal* journal, void* storage, size_t storage_size);
+
+// Forget every record. Call after anything that changes the game outside
+// journal_update_game (reset_game, seed_game, restore_game, ...), since the
+// records only make sense against the states they were taken from.
+void journal_clear(TickJournal* journal);
+
+// Same as update_game_ex, recording the tick in the journal first
+// Nothing is recorded when the call does nothing (game already over).
+bool journal_update_game(TickJournal* journal, GameState* game, TickDelta* out);
+
+// Undo the most recent recorded tick, restoring the game (and the turns that
+// were queued at the time) to the state before it. Returns false if the
+// journal is empty.
+bool undo_tick(TickJournal* journal, GameState* game);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_JOURNAL_H
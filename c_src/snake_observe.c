@@ -0,0 +1,101 @@
+#include "snake_observe.h"
+#include <string.h>
+
+// Number of channels rendered for the given flags
+int observation_channels(int flags) {
+    return (flags & OBS_WITH_AGE) ? 4 : 3;
+}
+
+// Bytes needed for one game's observation on a width x height board
+size_t observation_size(int width, int height, int flags) {
+    if (width <= 0 || height <= 0) return 0;
+    
+    return (size_t)width * (size_t)height * (size_t)observation_channels(flags);
+}
+
+// Age value for the segment at index (0 = head)
+static uint8_t segment_age(int index) {
+    return index >= 254 ? 255 : (uint8_t)(index + 1);
+}
+
+// Fill one game's planes; the body plane is a straight copy of the occupancy
+// grid (already 0/1 bytes), so the bulk of the work is memcpy/memset
+static void render_planes(uint8_t* block, size_t cells, const unsigned char* occupied,
+                          int head_cell, int food_cell) {
+    memset(block + OBS_CHANNEL_HEAD * cells, 0, cells);
+    memcpy(block + OBS_CHANNEL_BODY * cells, occupied, cells);
+    memset(block + OBS_CHANNEL_FOOD * cells, 0, cells);
+    
+    block[OBS_CHANNEL_HEAD * cells + (size_t)head_cell] = 1;
+    block[OBS_CHANNEL_BODY * cells + (size_t)head_cell] = 0;
+    if (food_cell >= 0) block[OBS_CHANNEL_FOOD * cells + (size_t)food_cell] = 1;
+}
+
+// Rasterize count games into out
+void render_observations(GameState* const* games, int count, uint8_t* out, int flags) {
+    if (!games || !out || count <= 0) return;
+    
+    const GameState* first = games[0];
+    if (!first) {
+        for (int g = 1; g < count && !first; g++) first = games[g];
+        if (!first) return;
+    }
+    
+    int width = first->width;
+    int height = first->height;
+    size_t cells = (size_t)width * (size_t)height;
+    size_t stride = observation_size(width, height, flags);
+    
+    for (int g = 0; g < count; g++) {
+        const GameState* game = games[g];
+        uint8_t* block = out + (size_t)g * stride;
+        if (!game || !game->body || game->width != width || game->height != height) {
+            memset(block, 0, stride);
+            continue;
+        }
+        
+        Point head = game->body[game->snake_head].position;
+        Point food = game->food.position;
+        int food_cell = food.x >= 0 ? food.y * width + food.x : -1;
+        render_planes(block, cells, game->occupied, head.y * width + head.x, food_cell);
+        
+        if (flags & OBS_WITH_AGE) {
+            uint8_t* age = block + OBS_CHANNEL_AGE * cells;
+            memset(age, 0, cells);
+            int slot = game->snake_head;
+            for (int i = 0; i < game->snake_length; i++) {
+                Point p = game->body[slot].position;
+                age[p.y * width + p.x] = segment_age(i);
+                if (++slot == game->capacity) slot = 0;
+            }
+        }
+    }
+}
+
+// Rasterize every game of a batch into out
+void batch_render_observations(const BatchGameState* batch, uint8_t* out, int flags) {
+    if (!batch || !out) return;
+    
+    int width = batch->width;
+    size_t cells = (size_t)batch->cells;
+    size_t stride = observation_size(batch->width, batch->height, flags);
+    
+    for (int g = 0; g < batch->count; g++) {
+        uint8_t* block = out + (size_t)g * stride;
+        const unsigned char* occupied = batch->occupied + (size_t)g * cells;
+        const int* body = batch->body + (size_t)g * cells;
+        int head_cell = batch->head_y[g] * width + batch->head_x[g];
+        int food_cell = batch->food_x[g] >= 0 ? batch->food_y[g] * width + batch->food_x[g] : -1;
+        render_planes(block, cells, occupied, head_cell, food_cell);
+        
+        if (flags & OBS_WITH_AGE) {
+            uint8_t* age = block + OBS_CHANNEL_AGE * cells;
+            memset(age, 0, cells);
+            int slot = batch->snake_head[g];
+            for (int i = 0; i < batch->snake_length[g]; i++) {
+                age[body[slot]] = segment_age(i);
+                if (++slot == batch->cells) slot = 0;
+            }
+        }
+    }
+}
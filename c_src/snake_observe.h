@@ -0,0 +1,45 @@
+#ifndef SNAKE_OBSERVE_H
+#define SNAKE_OBSERVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snake_core.h"
+#include "snake_batch.h"
+
+// Board rasterization for training pipelines. Each game becomes a stack of
+// uint8 planes, laid out [game][channel][y][x] in a caller-supplied buffer, so
+// Python can wrap the same memory with numpy.frombuffer / memoryview and
+// reshape it to (games, channels, height, width) without copying.
+
+// Channel order inside each game's block
+#define OBS_CHANNEL_HEAD 0  // 1 on the head cell
+#define OBS_CHANNEL_BODY 1  // 1 on every other snake cell
+#define OBS_CHANNEL_FOOD 2  // 1 on the food cell
+#define OBS_CHANNEL_AGE  3  // Ticks since the snake entered the cell, plus 1 (head = 1, capped at 255)
+
+// Flags for the render functions
+#define OBS_WITH_AGE 1  // Add the body age channel
+
+// Number of channels rendered for the given flags
+int observation_channels(int flags);
+
+// Bytes needed for one game's observation on a width x height board
+size_t observation_size(int width, int height, int flags);
+
+// Rasterize count games into out, observation_size bytes per game. All games
+// must share the first game's board size; other games (and NULL entries) are
+// written as all-zero planes.
+void render_observations(GameState* const* games, int count, uint8_t* out, int flags);
+
+// Rasterize every game of a batch into out, observation_size bytes per game
+void batch_render_observations(const BatchGameState* batch, uint8_t* out, int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_OBSERVE_H
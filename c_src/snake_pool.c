@@ -0,0 +1,224 @@
+#define _GNU_SOURCE
+#include "snake_pool.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Aim for this many chunks per participant so stealing has work to balance
+#define CHUNKS_PER_PARTICIPANT 8
+#define MIN_CHUNK_GAMES 16
+
+// One participant's share of the chunks; owners and thieves both claim chunks
+// by bumping next, so each chunk is handed out exactly once
+typedef struct {
+    _Alignas(64) atomic_int next;  // Next unclaimed chunk (own cache line)
+    int end;            // One past the last chunk of this share
+} ChunkQueue;
+
+typedef struct {
+    SnakePool* pool;
+    int index;          // Participant index (workers first, caller last)
+} WorkerContext;
+
+struct SnakePool {
+    int workers;        // Worker threads
+    int participants;   // Workers plus the calling thread
+    pthread_t* threads;
+    WorkerContext* contexts;
+    ChunkQueue* queues; // One per participant
+    
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;   // Signalled when a new job is posted
+    pthread_cond_t work_done;    // Signalled when the last worker leaves a job
+    unsigned long generation;    // Incremented for every job
+    int active;         // Workers still inside the current job
+    bool stopping;
+    
+    // Current job
+    BatchGameState* batch;
+    const uint8_t* actions;
+    int chunk_games;
+    atomic_int running; // Games still running after the step
+};
+
+// Step the games of one chunk
+static int run_chunk(SnakePool* pool, int chunk) {
+    int begin = chunk * pool->chunk_games;
+    return batch_update_range(pool->batch, pool->actions, begin, begin + pool->chunk_games);
+}
+
+// Drain this participant's own queue, then steal from the others
+static void run_job(SnakePool* pool, int self) {
+    int running = 0;
+    
+    for (int offset = 0; offset < pool->participants; offset++) {
+        ChunkQueue* queue = &pool->queues[(self + offset) % pool->participants];
+        for (;;) {
+            int chunk = atomic_fetch_add_explicit(&queue->next, 1, memory_order_relaxed);
+            if (chunk >= queue->end) break;
+            running += run_chunk(pool, chunk);
+        }
+    }
+    
+    atomic_fetch_add_explicit(&pool->running, running, memory_order_relaxed);
+}
+
+// Worker thread: wait for a job, run it, report back
+static void* worker_main(void* arg) {
+    WorkerContext* context = (WorkerContext*)arg;
+    SnakePool* pool = context->pool;
+    unsigned long seen = 0;
+    
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stopping && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->stopping) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        
+        run_job(pool, context->index);
+        
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    
+    return NULL;
+}
+
+// Pin a worker thread to one CPU (Linux only; elsewhere a no-op)
+static void pin_thread(pthread_t thread, int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread, sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+// Start a pool with the given number of worker threads
+SnakePool* snake_pool_create(int workers, const int* cpus) {
+    if (workers <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = online > 1 ? (int)online - 1 : 0;
+    }
+    
+    SnakePool* pool = calloc(1, sizeof(SnakePool));
+    if (!pool) return NULL;
+    
+    pool->workers = workers;
+    pool->participants = workers + 1;
+    pool->threads = calloc((size_t)(workers > 0 ? workers : 1), sizeof(pthread_t));
+    pool->contexts = calloc((size_t)(workers > 0 ? workers : 1), sizeof(WorkerContext));
+    pool->queues = aligned_alloc(64, sizeof(ChunkQueue) * (size_t)pool->participants);
+    if (!pool->threads || !pool->contexts || !pool->queues) {
+        free(pool->threads);
+        free(pool->contexts);
+        free(pool->queues);
+        free(pool);
+        return NULL;
+    }
+    for (int i = 0; i < pool->participants; i++) {
+        atomic_init(&pool->queues[i].next, 0);
+        pool->queues[i].end = 0;
+    }
+    
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+    
+    for (int i = 0; i < workers; i++) {
+        pool->contexts[i].pool = pool;
+        pool->contexts[i].index = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, &pool->contexts[i]) != 0) {
+            // Run with the threads that did start
+            pool->workers = i;
+            pool->participants = i + 1;
+            break;
+        }
+        if (cpus) pin_thread(pool->threads[i], cpus[i]);
+    }
+    
+    return pool;
+}
+
+// Stop and join the worker threads and free the pool
+void snake_pool_destroy(SnakePool* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    
+    for (int i = 0; i < pool->workers; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->work_done);
+    free(pool->threads);
+    free(pool->contexts);
+    free(pool->queues);
+    free(pool);
+}
+
+// Number of worker threads
+int snake_pool_workers(const SnakePool* pool) {
+    return pool ? pool->workers : 0;
+}
+
+// Step every game of the batch once, spread over the pool
+int batch_update_parallel(SnakePool* pool, BatchGameState* batch, const uint8_t* actions) {
+    if (!batch) return 0;
+    if (!pool || pool->workers == 0) return batch_update(batch, actions);
+    
+    // Size chunks so every participant starts with several to share
+    int participants = pool->participants;
+    int chunk_games = batch->count / (participants * CHUNKS_PER_PARTICIPANT);
+    if (chunk_games < MIN_CHUNK_GAMES) chunk_games = MIN_CHUNK_GAMES;
+    int chunks = (batch->count + chunk_games - 1) / chunk_games;
+    
+    pool->batch = batch;
+    pool->actions = actions;
+    pool->chunk_games = chunk_games;
+    atomic_store_explicit(&pool->running, 0, memory_order_relaxed);
+    
+    // Deal contiguous runs of chunks so each thread starts on its own memory
+    for (int i = 0; i < participants; i++) {
+        atomic_store_explicit(&pool->queues[i].next, chunks * i / participants, memory_order_relaxed);
+        pool->queues[i].end = chunks * (i + 1) / participants;
+    }
+    
+    // Publishing under the lock orders the job setup before the workers read it
+    pthread_mutex_lock(&pool->lock);
+    pool->active = pool->workers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    
+    run_job(pool, participants - 1);
+    
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    
+    return atomic_load_explicit(&pool->running, memory_order_relaxed);
+}
@@ -0,0 +1,41 @@
+#ifndef SNAKE_POOL_H
+#define SNAKE_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "snake_batch.h"
+
+// A fixed set of worker threads that step a BatchGameState in parallel. Each
+// call splits the batch into chunks of games, deals the chunks out evenly and
+// lets threads that run dry steal chunks from the others, so uneven chunk
+// costs (long snakes, finished games) do not leave cores idle.
+// The calling thread takes part in every job, and the call blocks until every
+// game has been stepped. Python's ctypes releases the GIL for the duration.
+typedef struct SnakePool SnakePool;
+
+// Start a pool with the given number of worker threads (0 or less means one per
+// online CPU, minus the calling thread). When cpus is not NULL, worker i is
+// pinned to CPU cpus[i] (a negative entry leaves that worker unpinned).
+// Threads are created once here; stepping allocates nothing.
+// Returns NULL if the pool could not be created.
+SnakePool* snake_pool_create(int workers, const int* cpus);
+
+// Stop and join the worker threads and free the pool
+void snake_pool_destroy(SnakePool* pool);
+
+// Number of worker threads (not counting the calling thread)
+int snake_pool_workers(const SnakePool* pool);
+
+// Step every game of the batch once, like batch_update, spread over the pool.
+// Only one thread may drive a given pool at a time.
+// Returns the number of games still running.
+int batch_update_parallel(SnakePool* pool, BatchGameState* batch, const uint8_t* actions);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_POOL_H
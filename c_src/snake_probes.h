@@ -0,0 +1,99 @@
+#ifndef SNAKE_PROBES_H
+#define SNAKE_PROBES_H
+
+// USDT (user-level statically defined tracing) probes for perf, bpftrace and
+// SystemTap, under the provider "snake". Each probe is a single nop plus an
+// ELF note recording where its arguments live, so it costs next to nothing
+// until a tracer attaches, and tracers can find it in an unmodified
+// libsnake.so, e.g.
+//   bpftrace -e 'usdt:./libsnake.so:snake:death { @[arg2] = hist(arg1); }'
+// Every argument is passed as a signed 64-bit value. Probes are emitted with
+// <sys/sdt.h> when it is available, otherwise with an equivalent built-in
+// definition on x86-64 ELF targets; elsewhere, or when built with
+// SNAKE_NO_USDT (`make USDT=0`), they compile to nothing. Not part of the
+// public API.
+//
+// Probes:
+//   tick_start(game)                           update_game entry
+//   tick_done(game, changed, length, score)    update_game return
+//   spawn(game, cell, free_count, board_full)  spawn_food; cell is -1 when the
+//                                              board is full and the food parked
+//   death(game, length, score, cause)          a tick ended the game (DeathCause)
+//   reset(game, length, score)                 reset_game, with the final
+//                                              length and score of the old game
+
+#if defined(SNAKE_NO_USDT)
+#define SNAKE_USDT_IMPL 0
+#elif defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define SNAKE_USDT_IMPL 1
+#endif
+#endif
+
+#if !defined(SNAKE_USDT_IMPL) && defined(__x86_64__) && defined(__ELF__) && defined(__GNUC__)
+#define SNAKE_USDT_IMPL 2
+#endif
+
+#ifndef SNAKE_USDT_IMPL
+#define SNAKE_USDT_IMPL 0
+#endif
+
+#if SNAKE_USDT_IMPL == 1
+
+#include <sys/sdt.h>
+
+#define SNAKE_PROBE1(name, a1) \
+    DTRACE_PROBE1(snake, name, (long)(a1))
+#define SNAKE_PROBE3(name, a1, a2, a3) \
+    DTRACE_PROBE3(snake, name, (long)(a1), (long)(a2), (long)(a3))
+#define SNAKE_PROBE4(name, a1, a2, a3, a4) \
+    DTRACE_PROBE4(snake, name, (long)(a1), (long)(a2), (long)(a3), (long)(a4))
+
+#elif SNAKE_USDT_IMPL == 2
+
+// Same layout as <sys/sdt.h> (note type 3 in .note.stapsdt): probe address,
+// address of the .stapsdt.base anchor, semaphore (none), provider, name and an
+// argument string like "-8@%rdi -8@$5" filled in by the asm operands
+#define SNAKE_SDT_ASM(name, args) \
+    "990: nop\n" \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+    ".balign 4\n" \
+    ".4byte 992f-991f, 994f-993f, 3\n" \
+    "991: .asciz \"stapsdt\"\n" \
+    "992: .balign 4\n" \
+    "993: .8byte 990b\n" \
+    ".8byte _.stapsdt.base\n" \
+    ".8byte 0\n" \
+    ".asciz \"snake\"\n" \
+    ".asciz \"" #name "\"\n" \
+    ".asciz \"" args "\"\n" \
+    "994: .balign 4\n" \
+    ".popsection\n" \
+    ".ifndef _.stapsdt.base\n" \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+    ".weak _.stapsdt.base\n" \
+    ".hidden _.stapsdt.base\n" \
+    "_.stapsdt.base: .space 1\n" \
+    ".size _.stapsdt.base, 1\n" \
+    ".popsection\n" \
+    ".endif\n"
+
+#define SNAKE_PROBE1(name, a1) \
+    __asm__ __volatile__(SNAKE_SDT_ASM(name, "-8@%0") :: "nor"((long)(a1)))
+#define SNAKE_PROBE3(name, a1, a2, a3) \
+    __asm__ __volatile__(SNAKE_SDT_ASM(name, "-8@%0 -8@%1 -8@%2") \
+                         :: "nor"((long)(a1)), "nor"((long)(a2)), "nor"((long)(a3)))
+#define SNAKE_PROBE4(name, a1, a2, a3, a4) \
+    __asm__ __volatile__(SNAKE_SDT_ASM(name, "-8@%0 -8@%1 -8@%2 -8@%3") \
+                         :: "nor"((long)(a1)), "nor"((long)(a2)), "nor"((long)(a3)), \
+                            "nor"((long)(a4)))
+
+#else
+
+#define SNAKE_PROBE1(name, a1) ((void)0)
+#define SNAKE_PROBE3(name, a1, a2, a3) ((void)0)
+#define SNAKE_PROBE4(name, a1, a2, a3, a4) ((void)0)
+
+#endif
+
+#endif // SNAKE_PROBES_H
@@ -0,0 +1,231 @@
+#include "snake_profile.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifdef SNAKE_PROFILE
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Counters of one timed function
+typedef struct {
+    atomic_uint_fast64_t calls;
+    atomic_uint_fast64_t total;
+    atomic_uint_fast64_t max;
+    atomic_uint_fast64_t histogram[PROFILE_HISTOGRAM_BUCKETS];
+} SiteCounters;
+
+// Counters of one thread. Only the owning thread writes them (plain loads and
+// stores, no read-modify-write); atomics let a dump read them at any time.
+// Blocks are never freed, so the counts of threads that exited still add up.
+typedef struct ProfileThread {
+    SiteCounters sites[PROFILE_SITE_COUNT];
+    atomic_uint_fast64_t events[PROFILE_EVENT_COUNT];
+    int index;          // Registration order, reported as the thread number
+    struct ProfileThread* next;
+} ProfileThread;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static ProfileThread* registry = NULL;  // Newest first
+static int registered_threads = 0;
+static _Thread_local ProfileThread* current_thread = NULL;
+
+static const char* const site_names[PROFILE_SITE_COUNT] = {
+    "update_game", "spawn_food", "check_self_collision"
+};
+static const char* const event_names[PROFILE_EVENT_COUNT] = {
+    "spawn_board_full"
+};
+
+// The calling thread's counters, registered on first use
+static ProfileThread* thread_counters(void) {
+    if (current_thread) return current_thread;
+    
+    ProfileThread* thread = calloc(1, sizeof(ProfileThread));
+    if (!thread) return NULL;
+    
+    pthread_mutex_lock(&registry_lock);
+    thread->index = registered_threads++;
+    thread->next = registry;
+    registry = thread;
+    pthread_mutex_unlock(&registry_lock);
+    
+    current_thread = thread;
+    return thread;
+}
+
+// Add to a counter only this thread writes
+static void add_relaxed(atomic_uint_fast64_t* counter, uint64_t amount) {
+    uint64_t value = atomic_load_explicit(counter, memory_order_relaxed);
+    atomic_store_explicit(counter, value + amount, memory_order_relaxed);
+}
+
+// Histogram bucket of a duration: floor(log2), with 0 in bucket 0
+static int bucket_of(uint64_t duration) {
+    return duration == 0 ? 0 : 63 - __builtin_clzll(duration);
+}
+
+// Add one call of the given duration to the calling thread's counters
+void profile_record(ProfileSite site, uint64_t duration) {
+    ProfileThread* thread = thread_counters();
+    if (!thread || (unsigned)site >= PROFILE_SITE_COUNT) return;
+    
+    SiteCounters* counters = &thread->sites[site];
+    add_relaxed(&counters->calls, 1);
+    add_relaxed(&counters->total, duration);
+    if (duration > atomic_load_explicit(&counters->max, memory_order_relaxed)) {
+        atomic_store_explicit(&counters->max, duration, memory_order_relaxed);
+    }
+    add_relaxed(&counters->histogram[bucket_of(duration)], 1);
+}
+
+// Count one event on the calling thread
+void profile_count(ProfileEvent event) {
+    ProfileThread* thread = thread_counters();
+    if (!thread || (unsigned)event >= PROFILE_EVENT_COUNT) return;
+    
+    add_relaxed(&thread->events[event], 1);
+}
+
+#endif // SNAKE_PROFILE
+
+// Appends formatted text to a caller buffer, tracking the full length even
+// once the buffer runs out
+typedef struct {
+    char* out;
+    size_t size;
+    size_t length;
+} JsonWriter;
+
+static void json_append(JsonWriter* writer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t room = writer->length < writer->size ? writer->size - writer->length : 0;
+    int written = vsnprintf(room ? writer->out + writer->length : NULL, room, format, args);
+    va_end(args);
+    if (written > 0) writer->length += (size_t)written;
+}
+
+#ifdef SNAKE_PROFILE
+
+// Plain copy of a thread's counters, or of several added together
+typedef struct {
+    uint64_t calls[PROFILE_SITE_COUNT];
+    uint64_t total[PROFILE_SITE_COUNT];
+    uint64_t max[PROFILE_SITE_COUNT];
+    uint64_t histogram[PROFILE_SITE_COUNT][PROFILE_HISTOGRAM_BUCKETS];
+    uint64_t events[PROFILE_EVENT_COUNT];
+} ProfileTotals;
+
+// Add a thread's counters into totals
+static void accumulate(ProfileTotals* totals, const ProfileThread* thread) {
+    for (int s = 0; s < PROFILE_SITE_COUNT; s++) {
+        const SiteCounters* counters = &thread->sites[s];
+        totals->calls[s] += atomic_load_explicit(&counters->calls, memory_order_relaxed);
+        totals->total[s] += atomic_load_explicit(&counters->total, memory_order_relaxed);
+        uint64_t max = atomic_load_explicit(&counters->max, memory_order_relaxed);
+        if (max > totals->max[s]) totals->max[s] = max;
+        for (int b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+            totals->histogram[s][b] += atomic_load_explicit(&counters->histogram[b],
+                                                            memory_order_relaxed);
+        }
+    }
+    for (int e = 0; e < PROFILE_EVENT_COUNT; e++) {
+        totals->events[e] += atomic_load_explicit(&thread->events[e], memory_order_relaxed);
+    }
+}
+
+// Write the "sites" and "events" members for one set of counters
+static void write_totals(JsonWriter* writer, const ProfileTotals* totals, const char* indent) {
+    json_append(writer, "%s\"sites\": {\n", indent);
+    for (int s = 0; s < PROFILE_SITE_COUNT; s++) {
+        json_append(writer, "%s  \"%s\": {\"calls\": %llu, \"total\": %llu, \"max\": %llu, "
+                    "\"histogram\": [", indent, site_names[s],
+                    (unsigned long long)totals->calls[s], (unsigned long long)totals->total[s],
+                    (unsigned long long)totals->max[s]);
+        
+        // Only non-empty buckets, as [lower bound, count] pairs
+        bool first = true;
+        for (int b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+            if (totals->histogram[s][b] == 0) continue;
+            json_append(writer, "%s[%llu, %llu]", first ? "" : ", ",
+                        b == 0 ? 0ULL : 1ULL << b, (unsigned long long)totals->histogram[s][b]);
+            first = false;
+        }
+        json_append(writer, "]}%s\n", s + 1 < PROFILE_SITE_COUNT ? "," : "");
+    }
+    json_append(writer, "%s},\n%s\"events\": {", indent, indent);
+    for (int e = 0; e < PROFILE_EVENT_COUNT; e++) {
+        json_append(writer, "%s\"%s\": %llu", e ? ", " : "", event_names[e],
+                    (unsigned long long)totals->events[e]);
+    }
+    json_append(writer, "}");
+}
+
+#endif // SNAKE_PROFILE
+
+// True if the library was built with SNAKE_PROFILE
+bool profile_enabled(void) {
+#ifdef SNAKE_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Write every counter as JSON into out
+size_t profile_dump_json(char* out, size_t size) {
+    JsonWriter writer = {out, out ? size : 0, 0};
+    if (writer.size > 0) out[0] = '\0';
+    
+#ifdef SNAKE_PROFILE
+    // Snapshot the list; blocks are only ever prepended, never removed
+    pthread_mutex_lock(&registry_lock);
+    ProfileThread* threads = registry;
+    pthread_mutex_unlock(&registry_lock);
+    
+    ProfileTotals totals = {0};
+    for (ProfileThread* thread = threads; thread; thread = thread->next) {
+        accumulate(&totals, thread);
+    }
+    
+    json_append(&writer, "{\n  \"enabled\": true,\n  \"clock\": \"%s\",\n", PROFILE_CLOCK_NAME);
+    write_totals(&writer, &totals, "  ");
+    json_append(&writer, ",\n  \"threads\": [\n");
+    for (ProfileThread* thread = threads; thread; thread = thread->next) {
+        ProfileTotals own;
+        memset(&own, 0, sizeof(own));
+        accumulate(&own, thread);
+        json_append(&writer, "    {\n      \"thread\": %d,\n", thread->index);
+        write_totals(&writer, &own, "      ");
+        json_append(&writer, "\n    }%s\n", thread->next ? "," : "");
+    }
+    json_append(&writer, "  ]\n}\n");
+#else
+    json_append(&writer, "{\"enabled\": false}\n");
+#endif
+    return writer.length;
+}
+
+// Zero every counter
+void profile_reset(void) {
+#ifdef SNAKE_PROFILE
+    pthread_mutex_lock(&registry_lock);
+    for (ProfileThread* thread = registry; thread; thread = thread->next) {
+        for (int s = 0; s < PROFILE_SITE_COUNT; s++) {
+            SiteCounters* counters = &thread->sites[s];
+            atomic_store_explicit(&counters->calls, 0, memory_order_relaxed);
+            atomic_store_explicit(&counters->total, 0, memory_order_relaxed);
+            atomic_store_explicit(&counters->max, 0, memory_order_relaxed);
+            for (int b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+                atomic_store_explicit(&counters->histogram[b], 0, memory_order_relaxed);
+            }
+        }
+        for (int e = 0; e < PROFILE_EVENT_COUNT; e++) {
+            atomic_store_explicit(&thread->events[e], 0, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+#endif
+}
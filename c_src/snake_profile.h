@@ -0,0 +1,95 @@
+#ifndef SNAKE_PROFILE_H
+#define SNAKE_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Optional instrumentation of the core. Built with `make PROFILE=1` (which
+// defines SNAKE_PROFILE), update_game, spawn_food and check_self_collision
+// count their calls and time each one with the cycle counter (rdtsc on x86,
+// nanoseconds elsewhere), keeping a total, a maximum and a log2 histogram of
+// the durations. spawn_food also counts the calls that find the board full and
+// park the food. Counters live in a block per thread, so recording never
+// contends; profile_dump_json adds them up on demand. Timings are inclusive,
+// so update_game includes the spawn_food and check_self_collision calls it
+// makes, and those calls are counted too. In a normal build the hooks compile
+// to nothing and the dump reports "enabled": false.
+
+// Timed functions
+typedef enum {
+    PROFILE_UPDATE_GAME = 0,
+    PROFILE_SPAWN_FOOD = 1,
+    PROFILE_CHECK_SELF_COLLISION = 2,
+    PROFILE_SITE_COUNT
+} ProfileSite;
+
+// Counted events
+typedef enum {
+    PROFILE_SPAWN_BOARD_FULL = 0,  // spawn_food found no free cell and parked the food
+    PROFILE_EVENT_COUNT
+} ProfileEvent;
+
+#define PROFILE_HISTOGRAM_BUCKETS 64  // Bucket k counts durations in [2^k, 2^(k+1)), bucket 0 also 0
+
+// True if the library was built with SNAKE_PROFILE
+bool profile_enabled(void);
+
+// Write every counter as JSON into out: totals over all threads, then each
+// thread's own. Returns the length of the whole document (excluding the
+// terminating NUL); if that is not less than size, the output was truncated,
+// so call with that length + 1 bytes. out may be NULL when size is 0.
+size_t profile_dump_json(char* out, size_t size);
+
+// Zero every counter; call while no thread is stepping games
+void profile_reset(void);
+
+#ifdef SNAKE_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_CLOCK_NAME "rdtsc"
+#else
+#include <time.h>
+#define PROFILE_CLOCK_NAME "ns"
+#endif
+
+// Current value of the profiling clock
+static inline uint64_t profile_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// Add one call of the given duration to the calling thread's counters
+void profile_record(ProfileSite site, uint64_t duration);
+
+// Count one event on the calling thread
+void profile_count(ProfileEvent event);
+
+// Hooks used by the core; a site's BEGIN and END must be in the same scope
+#define PROFILE_BEGIN(site) uint64_t profile_start_##site = profile_clock()
+#define PROFILE_END(site) profile_record(site, profile_clock() - profile_start_##site)
+#define PROFILE_EVENT(event) profile_count(event)
+
+#else
+
+#define PROFILE_BEGIN(site) ((void)0)
+#define PROFILE_END(site) ((void)0)
+#define PROFILE_EVENT(event) ((void)0)
+
+#endif // SNAKE_PROFILE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_PROFILE_H
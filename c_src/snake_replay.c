@@ -0,0 +1,522 @@
+#include "snake_replay.h"
+#include "snake_internal.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint8_t REPLAY_MAGIC[4] = {'S', 'N', 'K', 'R'};
+static const uint8_t INDEX_MAGIC[4] = {'S', 'N', 'K', 'I'};
+
+// Keyframe index entry and trailer sizes (fixed-width fields)
+#define INDEX_ENTRY_SIZE 16
+#define TRAILER_SIZE (8 + 8 + sizeof(INDEX_MAGIC))
+
+// Append bytes to the writer's buffer, flagging overflow instead of writing past it
+// A writer without a buffer only counts bytes, to size a record before writing it
+static bool put_bytes(ReplayWriter* writer, const void* bytes, size_t count) {
+    if (writer->overflow || count > writer->capacity - writer->size) {
+        writer->overflow = true;
+        return false;
+    }
+    
+    if (writer->buffer) memcpy(writer->buffer + writer->size, bytes, count);
+    writer->size += count;
+    return true;
+}
+
+// Append an unsigned LEB128 varint (7 bits per byte, high bit = more follows)
+static bool put_varint(ReplayWriter* writer, uint64_t value) {
+    uint8_t bytes[10];
+    size_t count = 0;
+    
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        bytes[count++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    
+    return put_bytes(writer, bytes, count);
+}
+
+// Append a fixed 8-byte little-endian integer
+static bool put_u64(ReplayWriter* writer, uint64_t value) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+    return put_bytes(writer, bytes, sizeof(bytes));
+}
+
+// Decode a fixed 8-byte little-endian integer
+static uint64_t load_u64(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)bytes[i] << (8 * i);
+    }
+    return value;
+}
+
+// Start recording a freshly seeded game
+bool replay_writer_init(ReplayWriter* writer, void* buffer, size_t capacity,
+                        const GameState* game, uint64_t seed, uint64_t stream) {
+    if (!writer || !buffer || !game) return false;
+    
+    writer->buffer = (uint8_t*)buffer;
+    writer->capacity = capacity;
+    writer->size = 0;
+    writer->tick = 0;
+    writer->last_event_tick = 0;
+    writer->last_direction = game->direction;
+    writer->keyframe_interval = REPLAY_KEYFRAME_INTERVAL;
+    writer->overflow = false;
+    
+    uint8_t version = REPLAY_VERSION;
+    put_bytes(writer, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    put_bytes(writer, &version, 1);
+    put_varint(writer, (uint64_t)game->width);
+    put_varint(writer, (uint64_t)game->height);
+    put_varint(writer, (uint64_t)game->capacity);
+    put_u64(writer, seed);
+    put_u64(writer, stream);
+    writer->records_offset = writer->size;
+    
+    return !writer->overflow;
+}
+
+// Encode the game's full state as a keyframe payload
+static void put_keyframe_payload(ReplayWriter* writer, const GameState* game, uint64_t tick) {
+    Point food = game->food.position;
+    
+    put_varint(writer, tick);
+    put_varint(writer, (uint64_t)game->direction);
+    put_varint(writer, (uint64_t)game->score);
+    put_varint(writer, game->game_over ? 1 : 0);
+    put_varint(writer, food.x < 0 ? 0 : (uint64_t)(food.y * game->width + food.x) + 1);
+    put_u64(writer, game->rng_state);
+    put_u64(writer, game->rng_inc);
+    
+    put_varint(writer, (uint64_t)game->snake_length);
+    for (int i = 0; i < game->snake_length; i++) {
+        int slot = game->snake_head + i;
+        if (slot >= game->capacity) slot -= game->capacity;
+        Point position = game->body[slot].position;
+        put_varint(writer, (uint64_t)(position.y * game->width + position.x));
+    }
+    
+    // The free-cell order decides where future food lands; the occupied rest
+    // of the list is the body's cells again and is rebuilt from it
+    put_varint(writer, (uint64_t)game->free_count);
+    for (int i = 0; i < game->free_count; i++) {
+        put_varint(writer, (uint64_t)game->free_cells[i]);
+    }
+}
+
+// Append a keyframe record: tag, payload size, payload
+static bool put_keyframe(ReplayWriter* writer, const GameState* game) {
+    ReplayWriter counter = {.capacity = SIZE_MAX};
+    put_keyframe_payload(&counter, game, writer->tick);
+    
+    put_varint(writer, REPLAY_KEYFRAME);
+    put_varint(writer, counter.size);
+    put_keyframe_payload(writer, game, writer->tick);
+    
+    // Later gaps count from the keyframe, so a reader can start right after it
+    writer->last_event_tick = writer->tick;
+    return !writer->overflow;
+}
+
+// Record one tick, emitting an event if it changed direction
+bool replay_record_tick(ReplayWriter* writer, const GameState* game) {
+    if (!writer || !game || writer->overflow) return false;
+    if (writer->tick >= REPLAY_MAX_TICKS) {
+        writer->overflow = true;
+        return false;
+    }
+    
+    writer->tick++;
+    if (game->direction != writer->last_direction) {
+        uint64_t gap = writer->tick - writer->last_event_tick;
+        if (!put_varint(writer, (gap << 2) | (uint64_t)game->direction)) return false;
+        writer->last_event_tick = writer->tick;
+        writer->last_direction = game->direction;
+    }
+    
+    if (writer->keyframe_interval > 0 && writer->tick % writer->keyframe_interval == 0) {
+        return put_keyframe(writer, game);
+    }
+    
+    return true;
+}
+
+// Read position inside a replay
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+} ReplayCursor;
+
+// Read an unsigned LEB128 varint; false if truncated or longer than 64 bits
+static bool get_varint(ReplayCursor* cursor, uint64_t* value) {
+    uint64_t result = 0;
+    
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (cursor->offset >= cursor->size) return false;
+        
+        uint8_t byte = cursor->data[cursor->offset++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+// Read a fixed 8-byte little-endian integer
+static bool get_u64(ReplayCursor* cursor, uint64_t* value) {
+    if (cursor->size - cursor->offset < 8) return false;
+    
+    *value = load_u64(cursor->data + cursor->offset);
+    cursor->offset += 8;
+    return true;
+}
+
+// Read a varint that must not exceed limit
+static bool get_bounded(ReplayCursor* cursor, uint64_t limit, uint64_t* value) {
+    return get_varint(cursor, value) && *value <= limit;
+}
+
+// Terminate the records and append the keyframe index
+size_t replay_writer_finish(ReplayWriter* writer) {
+    if (!writer) return 0;
+    
+    put_varint(writer, 0);
+    put_varint(writer, writer->tick);
+    if (writer->overflow) return 0;
+    
+    // Walk the records just written to list the keyframes
+    ReplayCursor cursor = {writer->buffer, writer->size, writer->records_offset};
+    uint64_t keyframes = 0;
+    uint64_t record;
+    while (get_varint(&cursor, &record) && record != 0) {
+        if (record != REPLAY_KEYFRAME) continue;
+        
+        size_t record_offset = cursor.offset - 1;
+        uint64_t payload_size = 0, tick = 0;
+        get_varint(&cursor, &payload_size);
+        size_t payload_offset = cursor.offset;
+        get_varint(&cursor, &tick);
+        put_u64(writer, tick);
+        put_u64(writer, record_offset);
+        keyframes++;
+        cursor.offset = payload_offset + payload_size;
+    }
+    
+    put_u64(writer, keyframes);
+    put_u64(writer, writer->tick);
+    put_bytes(writer, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    
+    return writer->overflow ? 0 : writer->size;
+}
+
+// Read and validate the header, leaving the cursor on the first record
+static bool read_header(ReplayCursor* cursor, ReplayHeader* header) {
+    if (cursor->size < sizeof(REPLAY_MAGIC) + 1) return false;
+    if (memcmp(cursor->data, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0) return false;
+    cursor->offset = sizeof(REPLAY_MAGIC);
+    
+    header->version = cursor->data[cursor->offset++];
+    if (header->version < 1 || header->version > REPLAY_VERSION) return false;
+    
+    uint64_t width, height, capacity;
+    if (!get_bounded(cursor, MAX_STORAGE_CELLS, &width) ||
+        !get_bounded(cursor, MAX_STORAGE_CELLS, &height) ||
+        !get_bounded(cursor, MAX_STORAGE_CELLS, &capacity)) return false;
+    
+    header->width = (int)width;
+    header->height = (int)height;
+    header->capacity = (int)capacity;
+    return get_u64(cursor, &header->seed) && get_u64(cursor, &header->stream);
+}
+
+// Parse the header of a replay
+bool replay_read_header(const void* data, size_t size, ReplayHeader* header) {
+    if (!data || !header) return false;
+    
+    ReplayCursor cursor = {(const uint8_t*)data, size, 0};
+    return read_header(&cursor, header);
+}
+
+// Tick the game until it has played target ticks
+static void run_straight(GameState* game, uint64_t* tick, uint64_t target) {
+    while (*tick < target && !game->game_over) {
+        update_game(game);
+        (*tick)++;
+    }
+    
+    // Ticks after the game ended change nothing
+    if (*tick < target) *tick = target;
+}
+
+// Play records from the cursor until the game has played target ticks. *tick
+// is the tick the cursor's gaps count from and total the replay's length from
+// its header or trailer, which no record may go past. Returns false if the
+// replay is malformed.
+static bool play_records(ReplayCursor* cursor, GameState* game, uint64_t* tick,
+                         uint64_t target, uint64_t total) {
+    uint64_t record;
+    
+    for (;;) {
+        if (!get_varint(cursor, &record)) return false;
+        if (record == 0) break;
+        
+        if (record == REPLAY_KEYFRAME) {
+            // Already simulated: only its tick matters, as the new base for gaps
+            uint64_t payload_size, keyframe_tick;
+            if (!get_varint(cursor, &payload_size)) return false;
+            size_t payload_offset = cursor->offset;
+            if (!get_varint(cursor, &keyframe_tick)) return false;
+            if (keyframe_tick < *tick || keyframe_tick > total) return false;
+            if (payload_size > cursor->size - payload_offset) return false;
+            
+            run_straight(game, tick, keyframe_tick < target ? keyframe_tick : target);
+            if (*tick == target) return true;
+            cursor->offset = payload_offset + payload_size;
+            continue;
+        }
+        
+        uint64_t gap = record >> 2;
+        if (gap == 0 || gap > total - *tick) return false;
+        
+        uint64_t event_tick = *tick + gap;
+        if (event_tick > target) {
+            run_straight(game, tick, target);
+            return true;
+        }
+        
+        // Run straight up to the tick before the event, then turn on the event's tick
+        run_straight(game, tick, event_tick - 1);
+        set_direction(game, (Direction)(record & 3));
+        update_game(game);
+        (*tick)++;
+    }
+    
+    uint64_t total_ticks;
+    if (!get_varint(cursor, &total_ticks) || total_ticks != total || target > total) return false;
+    
+    run_straight(game, tick, target);
+    return true;
+}
+
+// Re-simulate a whole replay on game
+bool replay_run(const void* data, size_t size, GameState* game) {
+    if (!data || !game || !game->body) return false;
+    
+    // Opening it checks the recorded length before anything is simulated
+    ReplayReader reader;
+    if (!replay_reader_open_memory(&reader, data, size)) return false;
+    if (reader.header.width != game->width || reader.header.height != game->height ||
+        reader.header.capacity != game->capacity) return false;
+    
+    seed_game(game, reader.header.seed, reader.header.stream);
+    
+    ReplayCursor cursor = {reader.data, reader.size, reader.records_offset};
+    uint64_t tick = 0;
+    return play_records(&cursor, game, &tick, reader.total_ticks, reader.total_ticks);
+}
+
+// Walk a replay that is already in memory
+bool replay_reader_open_memory(ReplayReader* reader, const void* data, size_t size) {
+    if (!reader || !data) return false;
+    
+    ReplayCursor cursor = {(const uint8_t*)data, size, 0};
+    if (!read_header(&cursor, &reader->header)) return false;
+    
+    reader->data = (const uint8_t*)data;
+    reader->size = size;
+    reader->records_offset = cursor.offset;
+    reader->keyframe_count = 0;
+    reader->keyframe_index = NULL;
+    reader->mapped = false;
+    
+    if (reader->header.version == 1) {
+        // No trailer: skip over the events once to learn the length
+        uint64_t record;
+        do {
+            if (!get_varint(&cursor, &record)) return false;
+        } while (record != 0);
+        return get_bounded(&cursor, REPLAY_MAX_TICKS, &reader->total_ticks);
+    }
+    
+    // The trailer at the very end locates the keyframe index
+    if (size - cursor.offset < TRAILER_SIZE) return false;
+    const uint8_t* trailer = reader->data + size - TRAILER_SIZE;
+    if (memcmp(trailer + 16, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) return false;
+    
+    uint64_t count = load_u64(trailer);
+    if (count > (size - cursor.offset - TRAILER_SIZE) / INDEX_ENTRY_SIZE) return false;
+    reader->keyframe_count = count;
+    reader->keyframe_index = trailer - count * INDEX_ENTRY_SIZE;
+    reader->total_ticks = load_u64(trailer + 8);
+    if (reader->total_ticks > REPLAY_MAX_TICKS) return false;
+    
+    // Seeking binary-searches the index, so its ticks must rise, stay within
+    // the replay and point at records
+    size_t records_end = (size_t)(reader->keyframe_index - reader->data);
+    uint64_t previous = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t tick = load_u64(reader->keyframe_index + i * INDEX_ENTRY_SIZE);
+        uint64_t offset = load_u64(reader->keyframe_index + i * INDEX_ENTRY_SIZE + 8);
+        if (tick <= previous || tick > reader->total_ticks) return false;
+        if (offset < reader->records_offset || offset >= records_end) return false;
+        previous = tick;
+    }
+    return true;
+}
+
+// Map a replay file read-only
+bool replay_reader_open(ReplayReader* reader, const char* path) {
+    if (!reader || !path) return false;
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    
+    size_t size = (size_t)info.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping stays valid without the descriptor
+    if (data == MAP_FAILED) return false;
+    
+    if (!replay_reader_open_memory(reader, data, size)) {
+        munmap(data, size);
+        return false;
+    }
+    reader->mapped = true;
+    return true;
+}
+
+// Unmap the file, if the reader mapped one
+void replay_reader_close(ReplayReader* reader) {
+    if (!reader) return;
+    
+    if (reader->mapped) munmap((void*)reader->data, reader->size);
+    reader->data = NULL;
+    reader->size = 0;
+    reader->mapped = false;
+}
+
+// Rebuild the game from the keyframe payload at the cursor. Version 2
+// keyframes list every cell after the free count rather than the free ones.
+static bool restore_keyframe(ReplayCursor* cursor, GameState* game, uint64_t* tick,
+                             int version) {
+    int cells = game->width * game->height;
+    uint64_t direction, score, game_over, food, length, free_count, value;
+    
+    if (!get_varint(cursor, tick) || !get_bounded(cursor, LEFT, &direction) ||
+        !get_bounded(cursor, INT32_MAX, &score) || !get_bounded(cursor, 1, &game_over) ||
+        !get_bounded(cursor, (uint64_t)cells, &food) ||
+        !get_u64(cursor, &game->rng_state) || !get_u64(cursor, &game->rng_inc) ||
+        !get_bounded(cursor, (uint64_t)game->capacity, &length) || length == 0) return false;
+    
+    game->direction = (Direction)direction;
+    game->input_head = 0;
+    game->input_count = 0;
+    game->score = (int)score;
+    game->game_over = game_over != 0;
+    game->food.value = FOOD_VALUE;
+    game->food.position.x = food == 0 ? -1 : (int)((food - 1) % (uint64_t)game->width);
+    game->food.position.y = food == 0 ? -1 : (int)((food - 1) / (uint64_t)game->width);
+    
+    // The body goes back in head-first order from slot 0
+    game->snake_head = 0;
+    game->snake_length = (int)length;
+    for (int i = 0; i < game->snake_length; i++) {
+        if (!get_bounded(cursor, (uint64_t)cells - 1, &value)) return false;
+        game->body[i].position.x = (int)value % game->width;
+        game->body[i].position.y = (int)value / game->width;
+    }
+    
+    // Free cells in their recorded order, each marked 2 in the grid so that a
+    // repeat is caught
+    if (!get_bounded(cursor, (uint64_t)cells, &free_count)) return false;
+    if ((uint64_t)cells - free_count != length) return false;
+    game->free_count = (int)free_count;
+    memset(game->occupied, 0, (size_t)cells);
+    for (int i = 0; i < game->free_count; i++) {
+        if (!get_bounded(cursor, (uint64_t)cells - 1, &value)) return false;
+        if (game->occupied[value]) return false;
+        game->occupied[value] = 2;
+        game->free_cells[i] = (int)value;
+        game->free_slot[value] = i;
+    }
+    if (version == 2) {
+        for (int i = game->free_count; i < cells; i++) {
+            if (!get_bounded(cursor, (uint64_t)cells - 1, &value)) return false;
+        }
+    }
+    
+    // The body takes the rest of the list. With as many segments as cells
+    // left, the body and the free cells cover the board as long as no segment
+    // lands on a marked cell.
+    for (int i = 0; i < game->snake_length; i++) {
+        int cell = game->body[i].position.y * game->width + game->body[i].position.x;
+        if (game->occupied[cell]) return false;
+        game->occupied[cell] = 1;
+        game->free_cells[game->free_count + i] = cell;
+        game->free_slot[cell] = game->free_count + i;
+    }
+    for (int i = 0; i < game->free_count; i++) {
+        game->occupied[game->free_cells[i]] = 0;
+    }
+    
+    // Food is never under the snake
+    if (food != 0 && game->occupied[food - 1]) return false;
+    
+    return true;
+}
+
+// Put game in the state it had after tick ticks
+bool replay_seek(const ReplayReader* reader, GameState* game, uint64_t tick) {
+    if (!reader || !reader->data || !game || !game->body) return false;
+    if (reader->header.width != game->width || reader->header.height != game->height ||
+        reader->header.capacity != game->capacity) return false;
+    if (tick > reader->total_ticks) return false;
+    
+    // Binary search for the last keyframe at or before tick
+    uint64_t low = 0;
+    uint64_t high = reader->keyframe_count;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        if (load_u64(reader->keyframe_index + middle * INDEX_ENTRY_SIZE) <= tick) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    
+    ReplayCursor cursor = {reader->data, reader->size, reader->records_offset};
+    uint64_t current = 0;
+    if (low == 0) {
+        seed_game(game, reader->header.seed, reader->header.stream);
+    } else {
+        // Skip the keyframe's tag and payload size, then restore its payload
+        uint64_t record, payload_size;
+        const uint8_t* entry = reader->keyframe_index + (low - 1) * INDEX_ENTRY_SIZE;
+        cursor.offset = load_u64(entry + 8);
+        if (cursor.offset >= reader->size) return false;
+        if (!get_varint(&cursor, &record) || record != REPLAY_KEYFRAME ||
+            !get_varint(&cursor, &payload_size)) return false;
+        if (!restore_keyframe(&cursor, game, &current, reader->header.version)) return false;
+        if (current != load_u64(entry)) return false;
+    }
+    
+    return play_records(&cursor, game, &current, tick, reader->total_ticks);
+}
@@ -0,0 +1,138 @@
+#ifndef SNAKE_REPLAY_H
+#define SNAKE_REPLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "snake_core.h"
+
+// Deterministic replays. A game is fully determined by its board, its seed and
+// the direction it moved in on each tick, so a replay stores only those: a
+// header, then one event per tick on which the direction changed, then the
+// number of ticks played. Re-running the events on a game seeded the same way
+// reproduces it bit for bit. Periodic keyframes hold the whole game state, so
+// a reader can seek to any tick by restoring the nearest keyframe before it and
+// re-simulating at most keyframe_interval ticks, however long the game is.
+//
+// Format (all integers are LEB128 varints unless noted):
+//   "SNKR"             4-byte magic
+//   version            1 byte, REPLAY_VERSION
+//   width, height      board size
+//   capacity           longest the snake could grow (depends on the storage)
+//   seed, stream       8 bytes each, little endian, as passed to seed_game
+//   records            either an event, (tick gap << 2 | direction) per direction
+//                      change, where the gap counts ticks since the previous
+//                      event or keyframe (or the start) and is at least 1;
+//                      or REPLAY_KEYFRAME, a payload size and the payload:
+//                      tick, direction, score, game over, food cell + 1 (0 when
+//                      parked), rng state and stream (8 bytes each), length,
+//                      body cells head first, free count, free cells in
+//                      free-list order (the occupied rest of the list is the
+//                      body's cells, in an order that is never observed)
+//   0                  end of records
+//   ticks              total number of ticks played
+//   keyframe index     (tick, offset of the record) per keyframe, 8 bytes each
+//   keyframe count     8 bytes
+//   ticks              8 bytes, repeated so the trailer alone describes the file
+//   "SNKI"             4-byte magic
+// Version 1 replays have neither keyframes nor the trailing index. Version 2
+// keyframes list every cell after the free count, the occupied ones last.
+
+#define REPLAY_VERSION 3
+#define REPLAY_KEYFRAME 1  // Record tag of a keyframe (an event never encodes to 1)
+#define REPLAY_KEYFRAME_INTERVAL 1024  // Default ticks between keyframes
+#define REPLAY_MAX_TICKS (1ULL << 28)  // Longest replay (about 52 days at 60 ticks per second)
+
+// Board and seed a replay was recorded with
+typedef struct {
+    int version;
+    int width;
+    int height;
+    int capacity;
+    uint64_t seed;
+    uint64_t stream;
+} ReplayHeader;
+
+// Appends a game's events to a caller-provided buffer; never allocates
+typedef struct {
+    uint8_t* buffer;    // Output buffer
+    size_t capacity;    // Size of the output buffer
+    size_t size;        // Bytes written so far
+    uint64_t tick;      // Ticks recorded so far
+    uint64_t last_event_tick;  // Tick of the most recent event (0 at the start)
+    Direction last_direction;  // Direction applied by the most recent tick
+    uint64_t keyframe_interval;  // Ticks between keyframes (0 = none)
+    size_t records_offset;  // Where the records start, after the header
+    bool overflow;      // Set once the buffer ran out of space
+} ReplayWriter;
+
+// Walks a replay in place, typically a read-only mapping of a replay file
+typedef struct {
+    const uint8_t* data;  // Start of the replay
+    size_t size;        // Bytes in the replay
+    ReplayHeader header;
+    size_t records_offset;  // First record after the header
+    uint64_t total_ticks;   // Ticks played in the replay
+    uint64_t keyframe_count;
+    const uint8_t* keyframe_index;  // (tick, offset) pairs, or NULL
+    bool mapped;        // data is an mmap owned by the reader
+} ReplayReader;
+
+// Start recording a game that was just started with seed_game(game, seed, stream),
+// writing the header into buffer. Keyframes are written every
+// REPLAY_KEYFRAME_INTERVAL ticks; change keyframe_interval before the first
+// tick to use another spacing. Returns false if the buffer is too small.
+bool replay_writer_init(ReplayWriter* writer, void* buffer, size_t capacity,
+                        const GameState* game, uint64_t seed, uint64_t stream);
+
+// Record one tick; call after every update_game / update_game_ex that returned
+// true. Returns false once the buffer is full or REPLAY_MAX_TICKS ticks have
+// been recorded (the replay is then unusable).
+bool replay_record_tick(ReplayWriter* writer, const GameState* game);
+
+// Terminate the records and append the keyframe index. Returns the total
+// replay size in bytes, or 0 if the buffer overflowed.
+size_t replay_writer_finish(ReplayWriter* writer);
+
+// Parse the header of a replay. Returns false if it is malformed or from an
+// unknown version.
+bool replay_read_header(const void* data, size_t size, ReplayHeader* header);
+
+// Re-simulate a whole replay as fast as possible on game, which must already be
+// initialized for the replay's board (initialize_game for a 100-segment
+// capacity, initialize_game_with_storage for a full-board one). The game is
+// re-seeded and ends in the recorded final state. Returns false if the replay
+// is malformed or does not match the game's board. Replays are checked
+// against their recorded length before anything is simulated, so a corrupted
+// one never costs more than REPLAY_MAX_TICKS ticks.
+bool replay_run(const void* data, size_t size, GameState* game);
+
+// Map a replay file read-only and prepare to walk it without copying
+// Returns false if the file cannot be mapped or is not a valid replay,
+// including one longer than REPLAY_MAX_TICKS or whose keyframe index is out of
+// order or points outside the records.
+bool replay_reader_open(ReplayReader* reader, const char* path);
+
+// Walk a replay that is already in memory (the data must outlive the reader)
+bool replay_reader_open_memory(ReplayReader* reader, const void* data, size_t size);
+
+// Unmap the file, if the reader mapped one
+void replay_reader_close(ReplayReader* reader);
+
+// Put game (initialized for the replay's board, as for replay_run) in the
+// state it had after tick ticks. Restores the last keyframe at or before tick
+// and re-simulates from there, so the cost is bounded by the keyframe interval
+// (version 1 replays re-simulate from the start). Returns false if tick is past
+// the end of the replay or the replay is malformed; the game is then
+// unspecified.
+bool replay_seek(const ReplayReader* reader, GameState* game, uint64_t tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_REPLAY_H
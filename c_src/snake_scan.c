@@ -0,0 +1,162 @@
+#include "snake_scan.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#if defined(__x86_64__)
+#define SNAKE_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// Compare one segment at a time
+int scan_segments_scalar(const SnakeSegment* segments, int count, Point position) {
+    for (int i = 0; i < count; i++) {
+        if (segments[i].position.x == position.x &&
+            segments[i].position.y == position.y) {
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
+#ifdef SNAKE_SCAN_X86
+
+// Turn a per-int equality mask over interleaved (x, y) pairs into one bit per
+// segment that matched on both coordinates
+static inline int pair_mask(int mask) {
+    return mask & (mask >> 1) & 0x55555555;
+}
+
+// Compare 8 segments per iteration with four 128-bit loads of two segments each
+int scan_segments_sse2(const SnakeSegment* segments, int count, Point position) {
+    const __m128i target = _mm_setr_epi32(position.x, position.y, position.x, position.y);
+    const int* packed = (const int*)segments;
+    int i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        const int* base = packed + 2 * i;
+        __m128i a = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(base + 0)), target);
+        __m128i b = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(base + 4)), target);
+        __m128i c = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(base + 8)), target);
+        __m128i d = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(base + 12)), target);
+        __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        if (!_mm_movemask_epi8(any)) continue;
+        
+        // Bits 0..15 hold 4 ints per vector, one bit per int
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(a)) |
+                   _mm_movemask_ps(_mm_castsi128_ps(b)) << 4 |
+                   _mm_movemask_ps(_mm_castsi128_ps(c)) << 8 |
+                   _mm_movemask_ps(_mm_castsi128_ps(d)) << 12;
+        int hits = pair_mask(mask);
+        if (hits) return i + __builtin_ctz((unsigned)hits) / 2;
+    }
+    
+    int rest = scan_segments_scalar(segments + i, count - i, position);
+    return rest < 0 ? -1 : i + rest;
+}
+
+// Compare 16 segments per iteration with four 256-bit loads of four segments each
+__attribute__((target("avx2")))
+static int scan_segments_avx2_impl(const SnakeSegment* segments, int count, Point position) {
+    const __m256i target = _mm256_setr_epi32(position.x, position.y, position.x, position.y,
+                                             position.x, position.y, position.x, position.y);
+    const int* packed = (const int*)segments;
+    int i = 0;
+    
+    for (; i + 16 <= count; i += 16) {
+        const int* base = packed + 2 * i;
+        __m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(base + 0)), target);
+        __m256i b = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(base + 8)), target);
+        __m256i c = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(base + 16)), target);
+        __m256i d = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(base + 24)), target);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+        if (_mm256_testz_si256(any, any)) continue;
+        
+        // Bits 0..31 hold 8 ints per vector, one bit per int
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(a)) |
+                        (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(b)) << 8 |
+                        (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(c)) << 16 |
+                        (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(d)) << 24;
+        unsigned hits = mask & (mask >> 1) & 0x55555555u;
+        if (hits) return i + __builtin_ctz(hits) / 2;
+    }
+    
+    int rest = scan_segments_sse2(segments + i, count - i, position);
+    return rest < 0 ? -1 : i + rest;
+}
+
+// Use AVX2 only when the running CPU supports it
+int scan_segments_avx2(const SnakeSegment* segments, int count, Point position) {
+    if (!__builtin_cpu_supports("avx2")) {
+        return scan_segments_sse2(segments, count, position);
+    }
+    
+    return scan_segments_avx2_impl(segments, count, position);
+}
+
+#else
+
+// Without x86 vector units every kernel is the scalar loop
+int scan_segments_sse2(const SnakeSegment* segments, int count, Point position) {
+    return scan_segments_scalar(segments, count, position);
+}
+
+int scan_segments_avx2(const SnakeSegment* segments, int count, Point position) {
+    return scan_segments_scalar(segments, count, position);
+}
+
+#endif
+
+typedef int (*ScanKernel)(const SnakeSegment* segments, int count, Point position);
+
+// Kernel chosen for this CPU, resolved on first use
+static _Atomic(ScanKernel) active_kernel = NULL;
+
+// Pick the widest kernel the CPU supports
+static ScanKernel resolve_kernel(void) {
+    ScanKernel kernel = atomic_load_explicit(&active_kernel, memory_order_acquire);
+    if (kernel) return kernel;
+    
+    kernel = scan_segments_scalar;
+#ifdef SNAKE_SCAN_X86
+    __builtin_cpu_init();
+    kernel = __builtin_cpu_supports("avx2") ? scan_segments_avx2_impl : scan_segments_sse2;
+#endif
+    
+    // Every thread resolves to the same kernel, so a racing store is harmless
+    atomic_store_explicit(&active_kernel, kernel, memory_order_release);
+    return kernel;
+}
+
+// Return the index of the first segment at position, or -1 if none matches
+int scan_segments(const SnakeSegment* segments, int count, Point position) {
+    if (!segments || count <= 0) return -1;
+    
+    return resolve_kernel()(segments, count, position);
+}
+
+// Name of the kernel scan_segments dispatches to
+const char* scan_segments_kernel(void) {
+    ScanKernel kernel = resolve_kernel();
+#ifdef SNAKE_SCAN_X86
+    if (kernel == scan_segments_avx2_impl) return "avx2";
+    if (kernel == scan_segments_sse2) return "sse2";
+#endif
+    return kernel == scan_segments_scalar ? "scalar" : "unknown";
+}
+
+// Return the index (0 = head) of the snake segment at position
+int find_snake_segment(GameState* game, Point position) {
+    if (!game || !game->body) return -1;
+    
+    // The ring holds the snake in at most two contiguous runs: from the head to
+    // the end of the buffer, then wrapped around from slot 0
+    int first_run = game->capacity - game->snake_head;
+    if (first_run > game->snake_length) first_run = game->snake_length;
+    
+    int index = scan_segments(game->body + game->snake_head, first_run, position);
+    if (index >= 0) return index;
+    
+    index = scan_segments(game->body, game->snake_length - first_run, position);
+    return index < 0 ? -1 : first_run + index;
+}
@@ -0,0 +1,36 @@
+#ifndef SNAKE_SCAN_H
+#define SNAKE_SCAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "snake_core.h"
+
+// Linear search over packed snake segments. The occupancy grid answers "is this
+// cell taken" in O(1), but not "which segment is it"; these kernels answer the
+// latter by comparing several segments per instruction. The best kernel for the
+// running CPU (AVX2, then SSE2, then scalar) is picked on first use, so a
+// single libsnake.so runs everywhere.
+
+// Return the index of the first segment at position, or -1 if none matches
+int scan_segments(const SnakeSegment* segments, int count, Point position);
+
+// Name of the kernel scan_segments dispatches to ("avx2", "sse2" or "scalar")
+const char* scan_segments_kernel(void);
+
+// Return the index (0 = head) of the snake segment at position, or -1 if the
+// position is not covered by the snake
+int find_snake_segment(GameState* game, Point position);
+
+// Individual kernels, exposed for benchmarking. A vector kernel falls back to
+// the scalar one when the CPU (or the build target) lacks its instructions.
+int scan_segments_scalar(const SnakeSegment* segments, int count, Point position);
+int scan_segments_sse2(const SnakeSegment* segments, int count, Point position);
+int scan_segments_avx2(const SnakeSegment* segments, int count, Point position);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_SCAN_H
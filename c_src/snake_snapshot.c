@@ -0,0 +1,231 @@
+#include "snake_snapshot.h"
+#include <stdint.h>
+#include <string.h>
+
+// Fixed part of a snapshot. It is followed by the body (Point per segment,
+// head first) and the free part of the free-cell list (int per free cell)
+typedef struct {
+    uint64_t rng_state;
+    uint64_t rng_inc;
+    uint32_t size;      // Total snapshot bytes, padding included
+    int width;
+    int height;
+    int capacity;
+    int snake_length;
+    int free_count;
+    Direction direction;
+    Point food;
+    int score;
+    Direction input_queue[INPUT_QUEUE_SIZE];
+    int input_head;
+    int input_count;
+    bool game_over;
+} SnapshotHeader;
+
+// Round up to the 8-byte granularity that keeps snapshots in an arena aligned
+static size_t padded(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+// Bytes of a snapshot holding length segments and free_count free cells
+static size_t layout_size(int length, int free_count) {
+    return padded(sizeof(SnapshotHeader) + (size_t)length * sizeof(Point) +
+                  (size_t)free_count * sizeof(int));
+}
+
+// Bytes a snapshot of the game takes right now
+size_t snapshot_size(const GameState* game) {
+    if (!game) return 0;
+    
+    return layout_size(game->snake_length, game->free_count);
+}
+
+// Largest snapshot the game can ever need
+size_t snapshot_max_size(const GameState* game) {
+    if (!game) return 0;
+    
+    // Every cell is either free or under the snake, and a segment takes more
+    // room than a free cell, so the longest snake gives the largest snapshot
+    int cells = game->width * game->height;
+    int length = game->capacity < cells ? game->capacity : cells;
+    return layout_size(length, cells - length);
+}
+
+// Write the game's live state to out
+size_t snapshot_game(const GameState* game, void* out, size_t out_size) {
+    if (!game || !out || (uintptr_t)out % 8 != 0) return 0;
+    
+    size_t size = snapshot_size(game);
+    if (out_size < size) return 0;
+    
+    SnapshotHeader* header = (SnapshotHeader*)out;
+    header->rng_state = game->rng_state;
+    header->rng_inc = game->rng_inc;
+    header->size = (uint32_t)size;
+    header->width = game->width;
+    header->height = game->height;
+    header->capacity = game->capacity;
+    header->snake_length = game->snake_length;
+    header->free_count = game->free_count;
+    header->direction = game->direction;
+    header->food = game->food.position;
+    header->score = game->score;
+    memcpy(header->input_queue, game->input_queue, sizeof(header->input_queue));
+    header->input_head = game->input_head;
+    header->input_count = game->input_count;
+    header->game_over = game->game_over;
+    
+    // The body in head-first order: at most two runs of the ring
+    Point* body = (Point*)(header + 1);
+    int first_run = game->capacity - game->snake_head;
+    if (first_run > game->snake_length) first_run = game->snake_length;
+    memcpy(body, game->body + game->snake_head, (size_t)first_run * sizeof(Point));
+    memcpy(body + first_run, game->body, (size_t)(game->snake_length - first_run) * sizeof(Point));
+    
+    // Only the free cells, in order; the rest of the list is the body's cells
+    int* free_cells = (int*)(body + game->snake_length);
+    memcpy(free_cells, game->free_cells, (size_t)game->free_count * sizeof(int));
+    
+    return size;
+}
+
+// Check the snapshot's cells against the board and, if they describe it,
+// write its occupancy grid; otherwise leave the game untouched. Every cell
+// must be on the board, the free cells and the body must be disjoint and
+// cover the board, and the food must be parked or on a free cell. The grid
+// doubles as scratch: free cells are set to 2 and segments to 4, plain stores
+// rather than read-modify-writes so the scatters stay cheap. There are exactly
+// as many entries as cells, so a repeated or overlapping entry leaves some
+// cell unset. An entry off the board sets cell 0 instead; on failure the old
+// grid is rebuilt from the game's own free list.
+static bool load_occupied(GameState* game, const Point* body, int length,
+                          const int* free_cells, int free_count, Point food) {
+    int width = game->width;
+    int height = game->height;
+    unsigned cells = (unsigned)(width * height);
+    unsigned char* occupied = game->occupied;
+    bool off_board = false;
+    
+    for (int i = 0; i < free_count; i++) {
+        unsigned cell = (unsigned)free_cells[i];
+        off_board |= cell >= cells;
+        occupied[cell < cells ? cell : 0] = 2;
+    }
+    for (int i = 0; i < length; i++) {
+        bool off = ((unsigned)body[i].x >= (unsigned)width) |
+                   ((unsigned)body[i].y >= (unsigned)height);
+        off_board |= off;
+        occupied[off ? 0 : body[i].y * width + body[i].x] = 4;
+    }
+    
+    bool valid = !off_board;
+    if (!(food.x == -1 && food.y == -1)) {
+        valid = valid && (unsigned)food.x < (unsigned)width && (unsigned)food.y < (unsigned)height &&
+                occupied[food.y * width + food.x] == 2;
+    }
+    
+    // Eight cells at a time: bit 0 of each byte of one_mark stays set while
+    // the cell holds 2 or 4
+    const uint64_t ones = 0x0101010101010101ULL;
+    uint64_t words = cells / 8;
+    uint64_t one_mark = ones;
+    for (uint64_t i = 0; i < words; i++) {
+        uint64_t grid;
+        memcpy(&grid, occupied + i * 8, 8);
+        one_mark &= (grid >> 1 ^ grid >> 2) & ones;
+    }
+    for (unsigned i = (unsigned)words * 8; i < cells; i++) {
+        one_mark &= (uint64_t)((occupied[i] >> 1 ^ occupied[i] >> 2) & 1) | ~(uint64_t)1;
+    }
+    valid = valid && one_mark == ones;
+    
+    if (!valid) {
+        const int* free_slot = game->free_slot;
+        int old_free_count = game->free_count;
+        for (unsigned i = 0; i < cells; i++) {
+            occupied[i] = free_slot[i] >= old_free_count;
+        }
+        return false;
+    }
+    
+    // Segments were set to 4, so the new grid is each byte shifted down by 2
+    for (uint64_t i = 0; i < words; i++) {
+        uint64_t grid;
+        memcpy(&grid, occupied + i * 8, 8);
+        grid = grid >> 2 & ones;
+        memcpy(occupied + i * 8, &grid, 8);
+    }
+    for (unsigned i = (unsigned)words * 8; i < cells; i++) {
+        occupied[i] >>= 2;
+    }
+    return true;
+}
+
+// Put game back in the state captured by snapshot_game
+bool restore_game(GameState* game, const void* snapshot, size_t size) {
+    if (!game || !game->body || !snapshot || (uintptr_t)snapshot % 8 != 0 ||
+        size < sizeof(SnapshotHeader)) return false;
+    
+    const SnapshotHeader* header = (const SnapshotHeader*)snapshot;
+    int cells_count = game->width * game->height;
+    if (header->width != game->width || header->height != game->height ||
+        header->capacity != game->capacity) return false;
+    if (header->snake_length < 1 || header->snake_length > game->capacity ||
+        header->free_count != cells_count - header->snake_length) return false;
+    if (header->size != layout_size(header->snake_length, header->free_count) ||
+        size < header->size) return false;
+    
+    // Scalars a tick relies on; game_over is read as a byte since a bool
+    // holding anything but 0 or 1 is undefined
+    unsigned char game_over;
+    memcpy(&game_over, &header->game_over, 1);
+    if ((unsigned)header->direction > LEFT || header->score < 0 || game_over > 1 ||
+        (header->rng_inc & 1) == 0) return false;
+    if (header->input_head < 0 || header->input_head >= INPUT_QUEUE_SIZE ||
+        header->input_count < 0 || header->input_count > INPUT_QUEUE_SIZE) return false;
+    for (int i = 0; i < header->input_count; i++) {
+        Direction queued = header->input_queue[(header->input_head + i) % INPUT_QUEUE_SIZE];
+        if ((unsigned)queued > LEFT) return false;
+    }
+    
+    const Point* body = (const Point*)(header + 1);
+    const int* saved_cells = (const int*)(body + header->snake_length);
+    if (!load_occupied(game, body, header->snake_length, saved_cells, header->free_count,
+                       header->food)) return false;
+    
+    game->rng_state = header->rng_state;
+    game->rng_inc = header->rng_inc;
+    game->snake_length = header->snake_length;
+    game->free_count = header->free_count;
+    game->direction = header->direction;
+    game->food.position = header->food;
+    game->score = header->score;
+    memcpy(game->input_queue, header->input_queue, sizeof(game->input_queue));
+    game->input_head = header->input_head;
+    game->input_count = header->input_count;
+    game->game_over = game_over;
+    
+    // The body goes back in one run starting at slot 0
+    game->snake_head = 0;
+    memcpy(game->body, body, (size_t)header->snake_length * sizeof(Point));
+    
+    // The free cells keep their order, which decides where future food lands.
+    // The occupied cells after them are the body's, in any order: the free list
+    // only ever swaps them past free_count, so their order is never observed.
+    // Locals, since stores to the byte grid could otherwise alias the pointers
+    int free_count = header->free_count;
+    int width = game->width;
+    int* free_cells = game->free_cells;
+    int* free_slot = game->free_slot;
+    memcpy(free_cells, saved_cells, (size_t)free_count * sizeof(int));
+    for (int i = 0; i < free_count; i++) {
+        free_slot[free_cells[i]] = i;
+    }
+    for (int i = 0; i < header->snake_length; i++) {
+        int cell = body[i].y * width + body[i].x;
+        free_cells[free_count + i] = cell;
+        free_slot[cell] = free_count + i;
+    }
+    
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef SNAKE_SNAPSHOT_H
+#define SNAKE_SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "snake_core.h"
+
+// Compact copies of a game's live state for tree search and rollback. A
+// snapshot holds the scalars, the body (head first, snake_length segments
+// rather than the whole ring) and the free part of the free-cell list, whose
+// order decides where future food lands. Everything else (the rest of the
+// list, the slot map and the occupancy grid) follows from those two and is
+// rebuilt on restore, so a snapshot takes 8 bytes per segment plus 4 per free
+// cell whatever the storage capacity. Snapshots are written to caller-owned
+// memory (e.g. a bump arena reset per search), are a multiple of 8 bytes long
+// and need 8-byte alignment.
+
+// Bytes a snapshot of the game takes right now, or 0 for NULL
+size_t snapshot_size(const GameState* game);
+
+// Largest snapshot the game can ever need, for sizing arenas
+size_t snapshot_max_size(const GameState* game);
+
+// Write the game's live state to out. Returns the bytes written (the value
+// snapshot_size reports), or 0 if out is NULL, misaligned or too small.
+size_t snapshot_game(const GameState* game, void* out, size_t out_size);
+
+// Put game back in the state captured by snapshot_game. The game must be
+// initialized for the same board and capacity as the snapshotted one (it may
+// be the same game or a clone). Returns false, leaving the game untouched, if
+// the snapshot does not match or is corrupt: scalars out of range, cells off
+// the board, or body and free cells that overlap or do not cover the board.
+bool restore_game(GameState* game, const void* snapshot, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_SNAPSHOT_H
@@ -0,0 +1,665 @@
+// Round-trip checks for the modules that promise to reproduce a game exactly:
+// replays against straight re-simulation, undo_tick against the state before
+// each tick, snapshot/restore and clone_game against the source game, and the
+// batch engine against the same games on GameState. Boards run from the
+// minimum size up, on the embedded arrays and on caller storage, and every
+// game is checked for internal consistency (body, occupancy grid and free list
+// agree) after each tick. Exits non-zero on the first failure.
+//
+// Usage: test_roundtrip [--games N]
+//   --games N  games per check (default 300)
+
+#include "snake_core.h"
+#include "snake_batch.h"
+#include "snake_journal.h"
+#include "snake_replay.h"
+#include "snake_snapshot.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TICKS 2000        // Ticks per game at most
+#define JOURNAL_TICKS 600     // Ticks per game in the journal check
+#define REPLAY_BUFFER (1 << 22)
+
+// A game and the caller storage it runs on, if any
+typedef struct {
+    GameState game;
+    void* storage;
+} TestGame;
+
+static int failures = 0;
+
+// Report a failed check with the game it happened in
+#define CHECK(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "FAIL %s:%d: ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+            return false; \
+        } \
+    } while (0)
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+// Random number in [0, bound)
+static int random_below(uint64_t* state, int bound) {
+    return (int)(next_random(state) % (uint64_t)bound);
+}
+
+// Pick a board for game index: every fourth game is the smallest board, the
+// rest are small random boards, now and then a large one
+static void pick_board(uint64_t* rng, int index, int* width, int* height) {
+    if (index % 4 == 0) {
+        *width = MIN_BOARD_WIDTH;
+        *height = MIN_BOARD_HEIGHT;
+    } else if (index % 25 == 1) {
+        *width = 64;
+        *height = 64;
+    } else {
+        *width = MIN_BOARD_WIDTH + random_below(rng, 16);
+        *height = MIN_BOARD_HEIGHT + random_below(rng, 12);
+    }
+}
+
+// Start a game on the embedded arrays or on caller storage sized for the board
+static bool open_game(TestGame* test, int width, int height, bool storage) {
+    test->storage = NULL;
+    if (!storage) {
+        initialize_game(&test->game, width, height);
+        return test->game.width == width && test->game.height == height;
+    }
+    
+    size_t size = game_storage_size(width, height);
+    test->storage = malloc(size);
+    return test->storage && initialize_game_with_storage(&test->game, width, height,
+                                                         test->storage, size);
+}
+
+static void close_game(TestGame* test) {
+    free(test->storage);
+    test->storage = NULL;
+}
+
+// Queue zero to two random turns, as a player mashing keys would
+static void random_turns(GameState* game, uint64_t* rng) {
+    int turns = random_below(rng, 3);
+    for (int i = 0; i < turns; i++) set_direction(game, (Direction)random_below(rng, 4));
+}
+
+// Check that the body, the occupancy grid and the free list describe the same
+// board: segments on the board and occupied, no cell twice, the free list a
+// permutation whose slot map inverts it, and the food on a free cell
+static bool check_consistent(const GameState* game, const char* where) {
+    int width = game->width;
+    int cells = width * game->height;
+    CHECK(game->snake_length >= 1 && game->snake_length <= game->capacity,
+          "%s: length %d", where, game->snake_length);
+    CHECK(game->free_count == cells - game->snake_length,
+          "%s: free_count %d with %d segments on %d cells", where, game->free_count,
+          game->snake_length, cells);
+    
+    for (int i = 0; i < cells; i++) {
+        int slot = game->free_slot[i];
+        CHECK(slot >= 0 && slot < cells && game->free_cells[slot] == i,
+              "%s: free_slot of cell %d is %d", where, i, slot);
+        CHECK(game->occupied[i] == (slot >= game->free_count),
+              "%s: cell %d occupied=%d but in slot %d of %d free", where, i, game->occupied[i],
+              slot, game->free_count);
+    }
+    
+    // Occupied cells number exactly snake_length, so segments on distinct
+    // occupied cells cover them all; each is flagged while checking
+    static unsigned char seen[MAX_STORAGE_CELLS];
+    bool ok = true;
+    for (int i = 0; i < game->snake_length && ok; i++) {
+        Point p = get_snake_segment((GameState*)game, i);
+        ok = p.x >= 0 && p.x < width && p.y >= 0 && p.y < game->height;
+        CHECK(ok, "%s: segment %d at (%d,%d) is off the %dx%d board", where, i, p.x, p.y,
+              width, game->height);
+        int cell = p.y * width + p.x;
+        ok = game->occupied[cell] && !seen[cell];
+        seen[cell] = 1;
+        if (!ok) fprintf(stderr, "%s: segment %d at (%d,%d) repeats or is not occupied\n",
+                         where, i, p.x, p.y);
+    }
+    for (int i = 0; i < game->snake_length; i++) {
+        Point p = get_snake_segment((GameState*)game, i);
+        if (p.x >= 0 && p.x < width && p.y >= 0 && p.y < game->height) seen[p.y * width + p.x] = 0;
+    }
+    CHECK(ok, "%s: body and occupancy grid disagree", where);
+    
+    Point food = game->food.position;
+    if (food.x >= 0) {
+        CHECK(food.x < width && food.y >= 0 && food.y < game->height &&
+              !game->occupied[food.y * width + food.x],
+              "%s: food at (%d,%d) is off the board or under the snake", where, food.x, food.y);
+    }
+    return true;
+}
+
+// Check that two games on the same board are in the same state: everything a
+// future tick can observe except queued turns, which replays do not record
+static bool check_same(const GameState* a, const GameState* b, const char* where) {
+    CHECK(a->snake_length == b->snake_length && a->score == b->score &&
+          a->game_over == b->game_over && a->direction == b->direction,
+          "%s: length %d/%d score %d/%d over %d/%d direction %d/%d", where, a->snake_length,
+          b->snake_length, a->score, b->score, a->game_over, b->game_over, a->direction,
+          b->direction);
+    CHECK(a->food.position.x == b->food.position.x && a->food.position.y == b->food.position.y,
+          "%s: food (%d,%d)/(%d,%d)", where, a->food.position.x, a->food.position.y,
+          b->food.position.x, b->food.position.y);
+    CHECK(a->rng_state == b->rng_state && a->rng_inc == b->rng_inc, "%s: generator", where);
+    
+    for (int i = 0; i < a->snake_length; i++) {
+        Point p = get_snake_segment((GameState*)a, i);
+        Point q = get_snake_segment((GameState*)b, i);
+        CHECK(p.x == q.x && p.y == q.y, "%s: segment %d (%d,%d)/(%d,%d)", where, i, p.x, p.y,
+              q.x, q.y);
+    }
+    
+    int cells = a->width * a->height;
+    CHECK(a->free_count == b->free_count &&
+          memcmp(a->free_cells, b->free_cells, (size_t)a->free_count * sizeof(int)) == 0,
+          "%s: free-cell order", where);
+    CHECK(memcmp(a->occupied, b->occupied, (size_t)cells) == 0, "%s: occupancy grid", where);
+    return true;
+}
+
+// Check that two games have the same turns queued, in the same order
+static bool check_same_queue(const GameState* a, const GameState* b, const char* where) {
+    CHECK(a->input_count == b->input_count, "%s: %d/%d queued turns", where, a->input_count,
+          b->input_count);
+    for (int i = 0; i < a->input_count; i++) {
+        Direction p = a->input_queue[(a->input_head + i) % INPUT_QUEUE_SIZE];
+        Direction q = b->input_queue[(b->input_head + i) % INPUT_QUEUE_SIZE];
+        CHECK(p == q, "%s: queued turn %d is %d/%d", where, i, p, q);
+    }
+    return true;
+}
+
+// Every board from the minimum up starts with its whole body on the board,
+// and the storage paths refuse boards narrower than MIN_BOARD_WIDTH
+static bool test_initial_layout(void) {
+    for (int width = MIN_BOARD_WIDTH; width <= MIN_BOARD_WIDTH + 8; width++) {
+        for (int height = MIN_BOARD_HEIGHT; height <= MIN_BOARD_HEIGHT + 6; height++) {
+            for (int storage = 0; storage < 2; storage++) {
+                TestGame test;
+                CHECK(open_game(&test, width, height, storage), "%dx%d storage=%d", width,
+                      height, storage);
+                bool ok = check_consistent(&test.game, "initial layout");
+                close_game(&test);
+                if (!ok) return false;
+            }
+        }
+    }
+    
+    static GameState clamped;
+    initialize_game(&clamped, MIN_BOARD_WIDTH - 1, MIN_BOARD_HEIGHT - 1);
+    CHECK(clamped.width == MIN_BOARD_WIDTH && clamped.height == MIN_BOARD_HEIGHT,
+          "undersized board clamped to %dx%d", clamped.width, clamped.height);
+    if (!check_consistent(&clamped, "clamped board")) return false;
+    
+    CHECK(game_storage_size(MIN_BOARD_WIDTH - 1, 8) == 0, "storage accepted a narrow board");
+    CHECK(batch_storage_size(4, MIN_BOARD_WIDTH - 1, 8) == 0, "batch accepted a narrow board");
+    return true;
+}
+
+// Decode the varint at data[*offset], advancing past it
+static uint64_t read_varint(const uint8_t* data, size_t* offset) {
+    uint64_t value = 0;
+    for (int shift = 0; ; shift += 7) {
+        uint8_t byte = data[(*offset)++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+// In the first keyframe, overwrite the first free cell with the head's cell,
+// so the free cells overlap the body and no longer cover the board. Returns
+// false if the replay has no keyframe, the board is full or the two cells do
+// not encode to the same number of bytes; on success *tick is the tick of the
+// corrupted keyframe.
+static bool corrupt_keyframe(uint8_t* data, size_t size, uint64_t* tick) {
+    ReplayReader reader;
+    if (!replay_reader_open_memory(&reader, data, size) || reader.keyframe_count == 0) return false;
+    
+    size_t offset = 0;
+    *tick = 0;
+    for (int i = 0; i < 8; i++) {
+        *tick |= (uint64_t)reader.keyframe_index[i] << (8 * i);
+        offset |= (size_t)reader.keyframe_index[8 + i] << (8 * i);
+    }
+    read_varint(data, &offset);  // Tag
+    read_varint(data, &offset);  // Payload size
+    for (int i = 0; i < 5; i++) read_varint(data, &offset);  // Tick .. food
+    offset += 16;  // Generator
+    uint64_t length = read_varint(data, &offset);
+    size_t head = offset;
+    for (uint64_t i = 0; i < length; i++) read_varint(data, &offset);
+    if (read_varint(data, &offset) == 0) return false;
+    
+    size_t head_end = head, free_end = offset;
+    read_varint(data, &head_end);
+    read_varint(data, &free_end);
+    size_t bytes = head_end - head;
+    if (bytes != free_end - offset) return false;
+    
+    memcpy(data + offset, data + head, bytes);
+    return true;
+}
+
+// Record random games, then re-run them whole and seek into them at random
+// ticks; every result must match the recorded game or straight re-simulation
+static bool test_replay(int games) {
+    static uint8_t buffer[REPLAY_BUFFER];
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    int corrupted = 0;
+    
+    for (int index = 0; index < games; index++) {
+        int width, height;
+        pick_board(&rng, index, &width, &height);
+        bool storage = index % 2 == 0;
+        TestGame original, replayed, seeker;
+        CHECK(open_game(&original, width, height, storage) &&
+              open_game(&replayed, width, height, storage) &&
+              open_game(&seeker, width, height, storage), "game %d: %dx%d", index, width, height);
+        
+        uint64_t seed = next_random(&rng);
+        seed_game(&original.game, seed, (uint64_t)index);
+        ReplayWriter writer;
+        CHECK(replay_writer_init(&writer, buffer, sizeof(buffer), &original.game, seed,
+                                 (uint64_t)index), "game %d: writer", index);
+        writer.keyframe_interval = (uint64_t)random_below(&rng, 5) * (1 + random_below(&rng, 100));
+        
+        int ticks = random_below(&rng, MAX_TICKS);
+        for (int t = 0; t < ticks; t++) {
+            random_turns(&original.game, &rng);
+            if (!update_game(&original.game)) break;
+            CHECK(replay_record_tick(&writer, &original.game), "game %d: record", index);
+            if (!check_consistent(&original.game, "recorded game")) return false;
+        }
+        size_t size = replay_writer_finish(&writer);
+        CHECK(size > 0, "game %d: finish", index);
+        
+        CHECK(replay_run(buffer, size, &replayed.game), "game %d: replay_run", index);
+        if (!check_same(&original.game, &replayed.game, "replay_run")) return false;
+        CHECK(!replay_run(buffer, size - 1, &replayed.game), "game %d: truncated replay ran", index);
+        
+        // Seeking through the index must agree with seeking without it, which
+        // re-simulates from the start
+        ReplayReader reader;
+        CHECK(replay_reader_open_memory(&reader, buffer, size) &&
+              reader.total_ticks == writer.tick, "game %d: reader", index);
+        ReplayReader straight = reader;
+        straight.keyframe_count = 0;
+        for (int q = 0; q < 8; q++) {
+            uint64_t tick = (uint64_t)random_below(&rng, (int)reader.total_ticks + 1);
+            CHECK(replay_seek(&reader, &seeker.game, tick), "game %d: seek %llu", index,
+                  (unsigned long long)tick);
+            if (!check_consistent(&seeker.game, "seek")) return false;
+            CHECK(replay_seek(&straight, &replayed.game, tick), "game %d: straight seek", index);
+            if (!check_same(&seeker.game, &replayed.game, "seek vs straight")) return false;
+        }
+        CHECK(replay_seek(&reader, &seeker.game, reader.total_ticks), "game %d: seek end", index);
+        if (!check_same(&seeker.game, &original.game, "seek to end")) return false;
+        CHECK(!replay_seek(&reader, &seeker.game, reader.total_ticks + 1),
+              "game %d: seek past end", index);
+        
+        // A keyframe whose free cells overlap the body must be refused
+        uint64_t keyframe_tick;
+        if (corrupt_keyframe(buffer, size, &keyframe_tick)) {
+            CHECK(replay_reader_open_memory(&reader, buffer, size), "game %d: reopen", index);
+            CHECK(!replay_seek(&reader, &seeker.game, keyframe_tick),
+                  "game %d: corrupted keyframe restored", index);
+            corrupted++;
+        }
+        
+        // So must a trailer claiming more ticks than any replay may hold
+        uint64_t too_long = REPLAY_MAX_TICKS + 1;
+        for (int i = 0; i < 8; i++) buffer[size - 12 + i] = (uint8_t)(too_long >> (8 * i));
+        CHECK(!replay_reader_open_memory(&reader, buffer, size), "game %d: overlong trailer", index);
+        CHECK(!replay_run(buffer, size, &replayed.game), "game %d: overlong replay ran", index);
+        
+        close_game(&original);
+        close_game(&replayed);
+        close_game(&seeker);
+    }
+    
+    CHECK(corrupted > 0, "no keyframe could be corrupted");
+    printf("replay: %d games, %d corrupted keyframes refused\n", games, corrupted);
+    return true;
+}
+
+// Play random games through the journal, snapshotting the state before every
+// tick, then undo them all; each undo must land on the snapshot before it
+static bool test_journal(int games) {
+    uint64_t rng = 0xD1B54A32D192ED03ULL;
+    long undone = 0;
+    
+    for (int index = 0; index < games; index++) {
+        int width, height;
+        pick_board(&rng, index, &width, &height);
+        bool storage = index % 2 == 0;
+        TestGame test, expected;
+        CHECK(open_game(&test, width, height, storage) &&
+              open_game(&expected, width, height, storage), "game %d: %dx%d", index, width, height);
+        seed_game(&test.game, next_random(&rng), 7);
+        
+        // Journals shorter than the game also check that the ring drops the oldest ticks
+        int capacity = 1 + random_below(&rng, JOURNAL_TICKS);
+        size_t journal_size = journal_storage_size(capacity);
+        void* journal_storage = malloc(journal_size);
+        size_t slot = snapshot_max_size(&test.game);
+        unsigned char* history = aligned_alloc(8, slot * JOURNAL_TICKS);
+        TickJournal journal;
+        CHECK(journal_storage && history && journal_init(&journal, journal_storage, journal_size),
+              "game %d: journal", index);
+        
+        int ticks = 0;
+        for (; ticks < JOURNAL_TICKS; ticks++) {
+            random_turns(&test.game, &rng);
+            CHECK(snapshot_game(&test.game, history + (size_t)ticks * slot, slot) > 0,
+                  "game %d: snapshot", index);
+            if (!journal_update_game(&journal, &test.game, NULL)) break;
+            if (!check_consistent(&test.game, "journaled tick")) return false;
+        }
+        
+        int kept = ticks < capacity ? ticks : capacity;
+        CHECK(journal.count == kept, "game %d: journal holds %d of %d", index, journal.count, kept);
+        for (int i = 1; i <= kept; i++) {
+            CHECK(undo_tick(&journal, &test.game), "game %d: undo %d", index, i);
+            CHECK(restore_game(&expected.game, history + (size_t)(ticks - i) * slot, slot),
+                  "game %d: restore", index);
+            if (!check_consistent(&test.game, "undone tick") ||
+                !check_same(&test.game, &expected.game, "undo_tick") ||
+                !check_same_queue(&test.game, &expected.game, "undo_tick")) return false;
+            undone++;
+        }
+        CHECK(!undo_tick(&journal, &test.game), "game %d: undo past the journal", index);
+        
+        free(history);
+        free(journal_storage);
+        close_game(&test);
+        close_game(&expected);
+    }
+    
+    printf("journal: %d games, %ld ticks undone\n", games, undone);
+    return true;
+}
+
+// Offset of the body and free cells in a snapshot of game: they end the
+// snapshot, ahead of its padding, so search for them from the back
+static size_t snapshot_cells_offset(const GameState* game, const unsigned char* snapshot,
+                                    size_t size) {
+    size_t bytes = (size_t)game->snake_length * sizeof(Point) +
+                   (size_t)game->free_count * sizeof(int);
+    unsigned char* cells = malloc(bytes);
+    Point* body = (Point*)cells;
+    for (int i = 0; i < game->snake_length; i++) body[i] = get_snake_segment((GameState*)game, i);
+    memcpy(body + game->snake_length, game->free_cells, (size_t)game->free_count * sizeof(int));
+    
+    size_t offset = size - bytes;
+    while (offset > 0 && memcmp(snapshot + offset, cells, bytes) != 0) offset -= 4;
+    free(cells);
+    return offset;
+}
+
+// Damage the cells of a snapshot of game in turn: a free cell off the board, a
+// free cell under the snake, the head off the board and a segment repeated.
+// Each must be refused with clone (restored from the intact snapshot) left as
+// it was.
+static bool check_corrupt_snapshots(const GameState* game, GameState* clone,
+                                    const unsigned char* snapshot, size_t size, int* corrupted) {
+    size_t offset = snapshot_cells_offset(game, snapshot, size);
+    CHECK(offset > 0, "snapshot cells not found");
+    int length = game->snake_length;
+    int cells = game->width * game->height;
+    Point head = get_snake_segment((GameState*)game, 0);
+    int head_cell = head.y * game->width + head.x;
+    
+    unsigned char* bad = aligned_alloc(8, size);
+    CHECK(bad, "corrupt snapshot buffer");
+    for (int damage = 0; damage < 4; damage++) {
+        memcpy(bad, snapshot, size);
+        Point* body = (Point*)(bad + offset);
+        int* free_cells = (int*)(body + length);
+        if (damage == 0 && game->free_count > 0) {
+            free_cells[0] = cells;
+        } else if (damage == 1 && game->free_count > 0) {
+            free_cells[0] = head_cell;
+        } else if (damage == 2) {
+            body[0].x = game->width;
+        } else if (damage == 3 && length > 1) {
+            body[length - 1] = body[0];
+        } else {
+            continue;
+        }
+        
+        bool restored = restore_game(clone, bad, size);
+        if (restored) free(bad);
+        CHECK(!restored, "corruption %d of a %dx%d snapshot restored", damage, game->width,
+              game->height);
+        if (!check_consistent(clone, "after a refused snapshot") ||
+            !check_same(game, clone, "after a refused snapshot")) {
+            free(bad);
+            return false;
+        }
+        (*corrupted)++;
+    }
+    free(bad);
+    return true;
+}
+
+// Snapshot random games mid-play, restore into a clone and into the original
+// after it moved on; both must be the snapshotted game, and play on alike
+static bool test_snapshot(int games) {
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    int corrupted = 0;
+    
+    for (int index = 0; index < games; index++) {
+        int width, height;
+        pick_board(&rng, index, &width, &height);
+        bool storage = index % 2 == 0;
+        TestGame test, clone, expected;
+        CHECK(open_game(&test, width, height, storage) && open_game(&clone, width, height, storage) &&
+              open_game(&expected, width, height, storage), "game %d: %dx%d", index, width, height);
+        seed_game(&test.game, next_random(&rng), 3);
+        
+        int ticks = random_below(&rng, MAX_TICKS / 4);
+        for (int t = 0; t < ticks; t++) {
+            random_turns(&test.game, &rng);
+            update_game(&test.game);
+        }
+        random_turns(&test.game, &rng);
+        
+        size_t max_size = snapshot_max_size(&test.game);
+        unsigned char* snapshot = aligned_alloc(8, max_size);
+        CHECK(snapshot, "game %d: snapshot buffer", index);
+        size_t size = snapshot_game(&test.game, snapshot, max_size);
+        CHECK(size > 0 && size == snapshot_size(&test.game) && size % 8 == 0,
+              "game %d: snapshot size %zu", index, size);
+        CHECK(restore_game(&clone.game, snapshot, size) && restore_game(&expected.game, snapshot, size),
+              "game %d: restore", index);
+        if (!check_consistent(&clone.game, "restored clone") ||
+            !check_same(&test.game, &clone.game, "clone") ||
+            !check_same_queue(&test.game, &clone.game, "clone")) return false;
+        CHECK(!restore_game(&clone.game, snapshot, size - 8), "game %d: short snapshot", index);
+        if (!check_corrupt_snapshots(&test.game, &clone.game, snapshot, size, &corrupted)) {
+            return false;
+        }
+        
+        // The clone plays on exactly like the original
+        uint64_t turns = rng;
+        for (int t = 0; t < 300; t++) {
+            random_turns(&test.game, &rng);
+            random_turns(&clone.game, &turns);
+            update_game(&test.game);
+            update_game(&clone.game);
+        }
+        if (!check_same(&test.game, &clone.game, "clone played on")) return false;
+        
+        // Rolling the original back recovers the snapshotted state
+        CHECK(restore_game(&test.game, snapshot, size), "game %d: rollback", index);
+        if (!check_consistent(&test.game, "rolled back") ||
+            !check_same(&test.game, &expected.game, "rollback") ||
+            !check_same_queue(&test.game, &expected.game, "rollback")) return false;
+        
+        free(snapshot);
+        close_game(&test);
+        close_game(&clone);
+        close_game(&expected);
+    }
+    
+    printf("snapshot: %d games, %d corrupted snapshots refused\n", games, corrupted);
+    return true;
+}
+
+// Clone random games mid-play on both storage layouts; the clone must match
+// the original, play on alike, and leave the original alone when it moves
+static bool test_clone(int games) {
+    uint64_t rng = 0x94D049BB133111EBULL;
+    
+    for (int index = 0; index < games; index++) {
+        int width, height;
+        pick_board(&rng, index, &width, &height);
+        bool storage = index % 2 == 0;
+        TestGame test, expected;
+        CHECK(open_game(&test, width, height, storage) &&
+              open_game(&expected, width, height, storage), "game %d: %dx%d", index, width, height);
+        seed_game(&test.game, next_random(&rng), 5);
+        
+        int ticks = random_below(&rng, MAX_TICKS / 4);
+        for (int t = 0; t < ticks; t++) {
+            random_turns(&test.game, &rng);
+            update_game(&test.game);
+        }
+        
+        static GameState clone;
+        size_t size = game_storage_size(width, height);
+        void* clone_storage = storage ? malloc(size) : NULL;
+        CHECK(!storage || !clone_game(&clone, &test.game, clone_storage, size - 1),
+              "game %d: clone into short storage", index);
+        CHECK(clone_game(&clone, &test.game, clone_storage, size) &&
+              clone_game(&expected.game, &test.game, expected.storage, size),
+              "game %d: clone", index);
+        if (!check_consistent(&clone, "clone") || !check_same(&test.game, &clone, "clone") ||
+            !check_same_queue(&test.game, &clone, "clone")) return false;
+        
+        // Playing the clone on must not touch the original, and the original
+        // must play on exactly as the clone did
+        uint64_t turns = rng;
+        for (int t = 0; t < 300; t++) {
+            random_turns(&clone, &rng);
+            update_game(&clone);
+        }
+        if (!check_consistent(&test.game, "cloned original") ||
+            !check_same(&test.game, &expected.game, "cloned original")) return false;
+        for (int t = 0; t < 300; t++) {
+            random_turns(&test.game, &turns);
+            update_game(&test.game);
+        }
+        if (!check_same(&test.game, &clone, "clone played on")) return false;
+        
+        free(clone_storage);
+        close_game(&test);
+        close_game(&expected);
+    }
+    
+    printf("clone: %d games\n", games);
+    return true;
+}
+
+// Step a batch and the same games on GameState with the same actions; every
+// game must match tick for tick, including on the smallest boards
+static bool test_batch(int games) {
+    enum { BATCH_GAMES = 16, BATCH_TICKS = 4000 };
+    uint64_t rng = 0xBF58476D1CE4E5B9ULL;
+    int boards = games / BATCH_GAMES > 4 ? games / BATCH_GAMES : 4;
+    
+    for (int index = 0; index < boards; index++) {
+        int width, height;
+        pick_board(&rng, index, &width, &height);
+        size_t size = batch_storage_size(BATCH_GAMES, width, height);
+        void* storage = aligned_alloc(8, (size + 7) & ~(size_t)7);
+        BatchGameState batch;
+        CHECK(storage && batch_init(&batch, BATCH_GAMES, width, height, storage, size),
+              "board %d: %dx%d batch", index, width, height);
+        
+        TestGame tests[BATCH_GAMES];
+        for (int i = 0; i < BATCH_GAMES; i++) {
+            CHECK(open_game(&tests[i], width, height, true), "board %d: game %d", index, i);
+            seed_game(&tests[i].game, 99, (uint64_t)i);
+            batch_seed_game(&batch, i, 99, (uint64_t)i);
+        }
+        
+        uint8_t actions[BATCH_GAMES];
+        for (int t = 0; t < BATCH_TICKS; t++) {
+            for (int i = 0; i < BATCH_GAMES; i++) {
+                int action = random_below(&rng, 6);
+                actions[i] = action < 4 ? (uint8_t)action : BATCH_NO_ACTION;
+                if (actions[i] != BATCH_NO_ACTION) set_direction(&tests[i].game, (Direction)action);
+                update_game(&tests[i].game);
+            }
+            batch_update(&batch, actions);
+            
+            for (int i = 0; i < BATCH_GAMES; i++) {
+                GameState* game = &tests[i].game;
+                Point head = get_snake_segment(game, 0);
+                CHECK(game->game_over == (bool)batch.done[i] && game->score == batch.score[i] &&
+                      game->snake_length == batch.snake_length[i] && head.x == batch.head_x[i] &&
+                      head.y == batch.head_y[i] && game->food.position.x == batch.food_x[i] &&
+                      game->food.position.y == batch.food_y[i],
+                      "board %d (%dx%d) game %d diverged at tick %d", index, width, height, i, t);
+                if (game->game_over) {
+                    reset_game(game);
+                    batch_reset_game(&batch, i);
+                }
+            }
+        }
+        
+        for (int i = 0; i < BATCH_GAMES; i++) close_game(&tests[i]);
+        free(storage);
+    }
+    
+    printf("batch: %d boards of %d games\n", boards, (int)BATCH_GAMES);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int games = 300;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--games N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (games < 1) games = 1;
+    
+    test_initial_layout();
+    if (failures == 0) test_replay(games);
+    if (failures == 0) test_journal(games);
+    if (failures == 0) test_snapshot(games);
+    if (failures == 0) test_clone(games);
+    if (failures == 0) test_batch(games);
+    
+    if (failures) {
+        printf("FAILED\n");
+        return 1;
+    }
+    printf("All round-trip checks passed\n");
+    return 0;
+}
@@ -3,10 +3,11 @@ import os
 import sys
 import ctypes
 import pygame
-from ctypes import c_int, c_bool, Structure, POINTER, c_void_p
+from ctypes import c_int, c_bool, c_ubyte, c_uint32, c_uint64, c_char_p, c_size_t, Structure, POINTER, c_void_p
 from enum import IntEnum
 import time
 import random
+import json
 
 # Ensure we can find the C library
 script_dir = os.path.dirname(os.path.abspath(__file__))
@@ -18,7 +19,14 @@ GRID_WIDTH = 20
 GRID_HEIGHT = 15
 WINDOW_WIDTH = CELL_SIZE * GRID_WIDTH
 WINDOW_HEIGHT = CELL_SIZE * GRID_HEIGHT
-FPS = 10  # Initial frames per second
+FPS = 10  # Initial simulation ticks per second
+MAX_FRAME_TIME = 0.25  # Longest stretch of wall time simulated in one frame
+
+# Frames per second for rendering and input polling. The simulation ticks at
+# its own score-driven rate and the snake is drawn part of the way to its next
+# cell in between. SNAKE_RENDER_FPS=0 restores lock-step frames (one tick per
+# frame at the tick rate), the baseline for the input latency report.
+RENDER_FPS = int(os.environ.get("SNAKE_RENDER_FPS", "60"))
 
 # Nokia-style color palette
 NOKIA_GREEN = (155, 188, 15)
@@ -27,6 +35,17 @@ NOKIA_LIGHT_GREEN = (170, 204, 34)
 NOKIA_DARKEST = (48, 56, 0)
 NOKIA_BACKGROUND = (48, 98, 48)
 
+# Set SNAKE_SURFACE_CACHE=0 to rebuild cached surfaces every frame, which gives
+# the uncached baseline for the frame-time report printed on exit
+SURFACE_CACHE_ENABLED = os.environ.get("SNAKE_SURFACE_CACHE", "1") != "0"
+
+# Set SNAKE_TRACE=trace.json to record the phases of every frame as Chrome
+# trace events, viewable in chrome://tracing or https://ui.perfetto.dev
+TRACE_PATH = os.environ.get("SNAKE_TRACE")
+
+# Set SNAKE_AUTOPILOT=1 to start with the built-in bot driving (P toggles it)
+AUTOPILOT_AT_START = os.environ.get("SNAKE_AUTOPILOT", "0") == "1"
+
 # Game phases
 class GamePhase:
     START_MENU = 0
@@ -40,6 +59,136 @@ class Direction(IntEnum):
     DOWN = 2
     LEFT = 3
 
+# Cell offset of one step in each direction
+DIRECTION_STEPS = {
+    Direction.UP: (0, -1),
+    Direction.RIGHT: (1, 0),
+    Direction.DOWN: (0, 1),
+    Direction.LEFT: (-1, 0),
+}
+
+class FrameTimer:
+    """Accumulates the time spent building frames, per game phase"""
+    def __init__(self):
+        self.totals = {}
+        self.counts = {}
+        self.worst = {}
+        self.started = 0.0
+    
+    def start(self):
+        self.started = time.perf_counter()
+    
+    def stop(self, phase_name):
+        elapsed = time.perf_counter() - self.started
+        self.totals[phase_name] = self.totals.get(phase_name, 0.0) + elapsed
+        self.counts[phase_name] = self.counts.get(phase_name, 0) + 1
+        self.worst[phase_name] = max(self.worst.get(phase_name, 0.0), elapsed)
+    
+    def report(self):
+        lines = [f"Frame time ({'cached' if SURFACE_CACHE_ENABLED else 'uncached'} surfaces):"]
+        for phase_name, total in self.totals.items():
+            count = self.counts[phase_name]
+            lines.append(f"  {phase_name:<10} {count:6d} frames, "
+                         f"avg {1000 * total / count:.3f} ms, "
+                         f"max {1000 * self.worst[phase_name]:.3f} ms")
+        return "\n".join(lines)
+
+class FrameTracer:
+    """Records the phases of each frame as Chrome/Perfetto trace events
+    
+    Spans are kept as tuples and written out in batches of FLUSH_EVENTS, so a
+    traced phase costs two clock reads and a list append. With no path the
+    tracer records nothing.
+    """
+    FLUSH_EVENTS = 4096
+    
+    def __init__(self, path):
+        self.path = path
+        self.enabled = path is not None
+        self.events = []
+        self.origin = time.perf_counter()
+        self.file = None
+        if self.enabled:
+            self.file = open(path, "w", buffering=1 << 16)
+            self.file.write('{"displayTimeUnit": "ms", "traceEvents": [\n'
+                            '{"name": "process_name", "ph": "M", "pid": 1, "tid": 1, '
+                            '"args": {"name": "snake_game"}}')
+    
+    def now(self):
+        return time.perf_counter()
+    
+    def span(self, name, start, args=None):
+        """Record a phase that began at start (a now() value) and ends now"""
+        if self.enabled:
+            self.events.append((name, start, time.perf_counter(), args))
+            if len(self.events) >= self.FLUSH_EVENTS:
+                self.flush()
+    
+    def flush(self):
+        if not self.events:
+            return
+        origin = self.origin
+        lines = []
+        for name, start, end, args in self.events:
+            extra = f', "args": {json.dumps(args)}' if args else ""
+            lines.append(f',\n{{"name": "{name}", "ph": "X", "pid": 1, "tid": 1, '
+                         f'"ts": {(start - origin) * 1e6:.3f}, "dur": {(end - start) * 1e6:.3f}{extra}}}')
+        self.file.write("".join(lines))
+        self.events.clear()
+    
+    def close(self):
+        """Write the remaining events and terminate the file"""
+        if not self.enabled or self.file is None:
+            return
+        self.flush()
+        self.file.write("\n]}\n")
+        self.file.close()
+        self.file = None
+        print(f"Frame trace written to {self.path}")
+
+class InputLatency:
+    """Estimates how long a key press takes to reach the screen during play"""
+    def __init__(self):
+        self.last_poll = None
+        self.poll_gap_total = 0.0
+        self.polls = 0
+        self.pending_since = None
+        self.present_total = 0.0
+        self.present_worst = 0.0
+        self.presses = 0
+    
+    def polled(self, now, key_pressed):
+        # A key press waits for the next poll, half a polling period on average
+        if self.last_poll is not None:
+            self.poll_gap_total += now - self.last_poll
+            self.polls += 1
+        self.last_poll = now
+        if key_pressed and self.pending_since is None:
+            self.pending_since = now
+    
+    def presented(self, now):
+        if self.pending_since is not None:
+            elapsed = now - self.pending_since
+            self.present_total += elapsed
+            self.present_worst = max(self.present_worst, elapsed)
+            self.presses += 1
+            self.pending_since = None
+    
+    def reset(self):
+        # Time spent outside gameplay is not a polling gap
+        self.last_poll = None
+        self.pending_since = None
+    
+    def report(self):
+        if self.presses == 0 or self.polls == 0:
+            return "Input latency: no key presses measured"
+        wait = 1000 * self.poll_gap_total / self.polls / 2
+        present = 1000 * self.present_total / self.presses
+        mode = f"{RENDER_FPS} fps render" if RENDER_FPS > 0 else "lock-step"
+        return (f"Input latency ({mode}): ~{wait + present:.1f} ms average "
+                f"({wait:.1f} ms waiting for the poll + {present:.1f} ms poll to screen, "
+                f"worst {1000 * self.present_worst:.1f} ms), {self.presses} key presses")
+
 # C struct definitions to match the C library
 class Point(Structure):
     _fields_ = [("x", c_int), ("y", c_int)]
@@ -50,16 +199,53 @@ class Food(Structure):
 class SnakeSegment(Structure):
     _fields_ = [("position", Point)]
 
+class TickDelta(Structure):
+    _fields_ = [
+        ("moved", c_bool),
+        ("new_head", Point),
+        ("vacated_tail", Point),
+        ("old_food", Point),
+        ("new_food", Point),
+        ("ate_food", c_bool),
+        ("score_delta", c_int),
+        ("wrapped", c_bool),
+        ("death", c_int)
+    ]
+
 class GameState(Structure):
     _fields_ = [
         ("width", c_int),
         ("height", c_int),
         ("snake", SnakeSegment * 100),  # MAX_SNAKE_LENGTH from snake_core.h
+        ("snake_head", c_int),  # Ring index of the head; use get_snake_segment
         ("snake_length", c_int),
         ("direction", c_int),
         ("food", Food),
         ("score", c_int),
-        ("game_over", c_bool)
+        ("game_over", c_bool),
+        ("occupied_storage", c_ubyte * (64 * 64)),  # MAX_BOARD_WIDTH * MAX_BOARD_HEIGHT
+        ("free_cells_storage", c_int * (64 * 64)),
+        ("free_slot_storage", c_int * (64 * 64)),
+        ("free_count", c_int),
+        ("capacity", c_int),
+        ("body", c_void_p),  # Active storage pointers, set by initialize_game
+        ("occupied", c_void_p),
+        ("free_cells", c_void_p),
+        ("free_slot", c_void_p),
+        ("rng_state", c_uint64),  # Per-game PCG32 generator
+        ("rng_inc", c_uint64),
+        ("input_queue", c_int * 4),  # INPUT_QUEUE_SIZE; turns waiting for a tick
+        ("input_head", c_int),
+        ("input_count", c_int)
+    ]
+
+class AutopilotScratch(Structure):
+    _fields_ = [
+        ("queue", c_void_p),  # Views into the storage passed to autopilot_init
+        ("stamp", c_void_p),
+        ("first_move", c_void_p),
+        ("generation", c_uint32),
+        ("cells", c_int)
     ]
 
 # Load the C library
@@ -77,9 +263,15 @@ snake_lib.initialize_game.restype = None
 snake_lib.update_game.argtypes = [POINTER(GameState)]
 snake_lib.update_game.restype = c_bool
 
+snake_lib.update_game_ex.argtypes = [POINTER(GameState), POINTER(TickDelta)]
+snake_lib.update_game_ex.restype = c_bool
+
 snake_lib.set_direction.argtypes = [POINTER(GameState), c_int]
 snake_lib.set_direction.restype = None
 
+snake_lib.peek_direction.argtypes = [POINTER(GameState)]
+snake_lib.peek_direction.restype = c_int
+
 snake_lib.check_self_collision.argtypes = [POINTER(GameState), Point]
 snake_lib.check_self_collision.restype = c_bool
 
@@ -92,6 +284,9 @@ snake_lib.spawn_food.restype = None
 snake_lib.get_snake_segment.argtypes = [POINTER(GameState), c_int]
 snake_lib.get_snake_segment.restype = Point
 
+snake_lib.copy_snake_segments.argtypes = [POINTER(GameState), POINTER(Point), c_int]
+snake_lib.copy_snake_segments.restype = c_int
+
 snake_lib.get_food_position.argtypes = [POINTER(GameState)]
 snake_lib.get_food_position.restype = Point
 
@@ -104,6 +299,28 @@ snake_lib.is_game_over.restype = c_bool
 snake_lib.reset_game.argtypes = [POINTER(GameState)]
 snake_lib.reset_game.restype = None
 
+snake_lib.profile_enabled.argtypes = []
+snake_lib.profile_enabled.restype = c_bool
+
+snake_lib.profile_dump_json.argtypes = [c_char_p, c_size_t]
+snake_lib.profile_dump_json.restype = c_size_t
+
+snake_lib.autopilot_scratch_size.argtypes = [c_int, c_int]
+snake_lib.autopilot_scratch_size.restype = c_size_t
+
+snake_lib.autopilot_init.argtypes = [POINTER(AutopilotScratch), c_int, c_int, c_void_p, c_size_t]
+snake_lib.autopilot_init.restype = c_bool
+
+snake_lib.autopilot_choose_direction.argtypes = [POINTER(GameState), POINTER(AutopilotScratch)]
+snake_lib.autopilot_choose_direction.restype = c_int
+
+def core_profile_json():
+    """Counters of a library built with `make PROFILE=1`, as a JSON string"""
+    size = snake_lib.profile_dump_json(None, 0)
+    buffer = ctypes.create_string_buffer(size + 1)
+    snake_lib.profile_dump_json(buffer, size + 1)
+    return buffer.value.decode()
+
 class SnakeGame:
     def __init__(self):
         # Initialize Pygame
@@ -122,6 +339,42 @@ class SnakeGame:
         self.game_state = GameState()
         snake_lib.initialize_game(self.game_state, GRID_WIDTH, GRID_HEIGHT)
         
+        # Reusable buffer the whole snake is copied into once per frame
+        self.segment_buffer = (Point * self.game_state.capacity)()
+        
+        # What the last tick changed, and a view of the occupancy grid, so
+        # frames can repaint just those cells
+        self.tick_delta = TickDelta()
+        self.occupied = ctypes.cast(self.game_state.occupied, POINTER(c_ubyte))
+        self.needs_full_redraw = True
+        self.drawn_score = None
+        self.score_rect = pygame.Rect(10, 10, 0, 0)
+        self.drawn_effect_rects = []
+        self.drawn_sprite_cells = []
+        
+        # Fixed-timestep simulation: wall time accumulates until it covers a
+        # tick, and motion is how far the snake is towards its next tick
+        self.tick_accumulator = 0.0
+        self.last_frame_time = time.perf_counter()
+        self.motion = 0.0
+        self.input_latency = InputLatency()
+        
+        # Pre-rendered surfaces (background, text, overlays, menu), rebuilt
+        # only when the value they depend on changes
+        self.surface_cache = {}
+        self.game_over_count = 0
+        self.frame_timer = FrameTimer()
+        self.tracer = FrameTracer(TRACE_PATH)
+        
+        # Built-in bot; its search arena is allocated once and reused every tick
+        scratch_size = snake_lib.autopilot_scratch_size(GRID_WIDTH, GRID_HEIGHT)
+        self.autopilot_storage = (c_uint64 * ((scratch_size + 7) // 8))()
+        self.autopilot_scratch = AutopilotScratch()
+        snake_lib.autopilot_init(self.autopilot_scratch, GRID_WIDTH, GRID_HEIGHT,
+                                 self.autopilot_storage, scratch_size)
+        self.autopilot = False
+        self.set_autopilot(AUTOPILOT_AT_START)
+        
         # Game control variables
         self.running = True
         self.phase = GamePhase.START_MENU
@@ -136,16 +389,28 @@ class SnakeGame:
         
     def run(self):
         """Main game loop"""
+        tracer = self.tracer
         while self.running:
+            frame_start = tracer.now()
+            self.frame_timer.start()
             if self.phase == GamePhase.START_MENU:
                 self.handle_start_menu()
+                self.frame_timer.stop("menu")
+                tracer.span("handle_start_menu", frame_start)
             elif self.phase == GamePhase.PLAYING:
                 self.handle_gameplay()
+                self.frame_timer.stop("playing")
+                tracer.span("handle_gameplay", frame_start)
             elif self.phase == GamePhase.GAME_OVER:
                 self.handle_game_over()
+                self.frame_timer.stop("game over")
+                tracer.span("handle_game_over", frame_start)
             
-            # Maintain frame rate
-            self.clock.tick(self.current_fps)
+            # Maintain frame rate: display rate, or the tick rate in lock-step mode
+            wait_start = tracer.now()
+            self.clock.tick(RENDER_FPS if RENDER_FPS > 0 else self.current_fps)
+            tracer.span("clock.tick", wait_start)
+            tracer.span("frame", frame_start)
             
     def handle_start_menu(self):
         """Handle the start menu phase"""
@@ -155,70 +420,146 @@ class SnakeGame:
             elif event.type == pygame.KEYDOWN:
                 if event.key == pygame.K_RETURN or event.key == pygame.K_SPACE:
                     self.phase = GamePhase.PLAYING
+                    self.needs_full_redraw = True
+                    self.tick_accumulator = 0.0
+                    self.last_frame_time = time.perf_counter()
+                    self.input_latency.reset()
                 elif event.key == pygame.K_ESCAPE:
                     self.running = False
         
-        # Render start menu
-        self.screen.fill(NOKIA_BACKGROUND)
+        # Render start menu (static, so it is drawn once and reused)
+        self.screen.blit(self.cached_surface("menu", self.build_menu_surface), (0, 0))
+        
+        pygame.display.flip()
+    
+    def build_menu_surface(self):
+        """Draw the start menu onto a new surface"""
+        surface = pygame.Surface((WINDOW_WIDTH, WINDOW_HEIGHT))
+        surface.fill(NOKIA_BACKGROUND)
         
         # Draw title
         title_text = self.font.render("NOKIA SNAKE", True, NOKIA_GREEN)
         title_rect = title_text.get_rect(center=(WINDOW_WIDTH//2, WINDOW_HEIGHT//3))
-        self.screen.blit(title_text, title_rect)
+        surface.blit(title_text, title_rect)
         
         # Draw instruction
         instruction_text = self.small_font.render("Press SPACE to start", True, NOKIA_LIGHT_GREEN)
         instruction_rect = instruction_text.get_rect(center=(WINDOW_WIDTH//2, WINDOW_HEIGHT*2//3))
-        self.screen.blit(instruction_text, instruction_rect)
+        surface.blit(instruction_text, instruction_rect)
         
         # Draw small snake icon
-        self.draw_snake_icon()
+        self.draw_snake_icon(surface)
         
-        pygame.display.flip()
+        return surface
     
-    def draw_snake_icon(self):
+    def draw_snake_icon(self, surface):
         """Draw a small snake icon for the menu"""
         snake_x, snake_y = WINDOW_WIDTH//2, WINDOW_HEIGHT//2
         
         # Draw snake body segments
         for i in range(5):
-            pygame.draw.rect(self.screen, NOKIA_GREEN, 
+            pygame.draw.rect(surface, NOKIA_GREEN, 
                             (snake_x - i*10, snake_y, 8, 8))
         
         # Draw food
-        pygame.draw.rect(self.screen, NOKIA_LIGHT_GREEN, 
+        pygame.draw.rect(surface, NOKIA_LIGHT_GREEN, 
                         (snake_x + 15, snake_y, 8, 8))
     
     def handle_gameplay(self):
         """Handle the main gameplay phase"""
-        # Process events
+        # Process events every frame, so a turn is picked up within one display frame
+        tracer = self.tracer
+        phase_start = tracer.now()
+        key_pressed = False
         for event in pygame.event.get():
             if event.type == pygame.QUIT:
                 self.running = False
             elif event.type == pygame.KEYDOWN:
                 self.handle_key_press(event.key)
-        
+                key_pressed = True
+        
+        now = time.perf_counter()
+        self.input_latency.polled(now, key_pressed)
+        tracer.span("events", phase_start)
+        
+        # Run as many fixed-length ticks as the elapsed time covers
+        ticks = 0
+        if RENDER_FPS > 0:
+            self.tick_accumulator += min(now - self.last_frame_time, MAX_FRAME_TIME)
+            self.last_frame_time = now
+            while self.phase == GamePhase.PLAYING and self.tick_accumulator >= 1.0 / self.current_fps:
+                self.tick_accumulator -= 1.0 / self.current_fps
+                self.step_game()
+                ticks += 1
+            self.motion = min(self.tick_accumulator * self.current_fps, 1.0)
+        else:
+            self.step_game()
+            ticks = 1
+        
+        # Render game: a full frame when entering play or after a catch-up of
+        # several ticks, otherwise only the cells that changed
+        phase_start = tracer.now()
+        if self.needs_full_redraw or ticks > 1:
+            self.render_game()
+            tracer.span("render_game", phase_start)
+            phase_start = tracer.now()
+            pygame.display.flip()
+            tracer.span("display.flip", phase_start)
+            self.needs_full_redraw = False
+        else:
+            dirty = self.render_dirty(self.tick_delta if ticks else None)
+            tracer.span("render_dirty", phase_start, {"rects": len(dirty)})
+            phase_start = tracer.now()
+            pygame.display.update(dirty)
+            tracer.span("display.update", phase_start)
+        self.input_latency.presented(time.perf_counter())
+    
+    def step_game(self):
+        """Advance the simulation by one tick"""
         # Update game state through C library
-        updated = snake_lib.update_game(self.game_state)
+        tracer = self.tracer
+        phase_start = tracer.now()
+        delta = self.tick_delta
+        if self.autopilot:
+            snake_lib.set_direction(self.game_state, snake_lib.autopilot_choose_direction(
+                self.game_state, self.autopilot_scratch))
+        snake_lib.update_game_ex(self.game_state, delta)
+        tracer.span("update_game", phase_start)
         
         # Check if game is over
         if self.game_state.game_over:
             self.phase = GamePhase.GAME_OVER
+            self.game_over_count += 1
         
         # Update speed based on score
         self.update_game_speed()
         
-        # Update visual effects
-        self.update_effects()
-        
-        # Render game
-        self.render_game()
+        # Start effects for what happened this tick
+        if delta.wrapped:
+            self.teleport_effect = [Point(delta.new_head.x, delta.new_head.y), 10, NOKIA_LIGHT_GREEN]
+        if delta.ate_food:
+            self.create_eat_effect(Point(delta.new_head.x, delta.new_head.y))
         
-        pygame.display.flip()
+        # Update visual effects (they run on ticks, not frames)
+        phase_start = tracer.now()
+        self.update_effects()
+        tracer.span("update_effects", phase_start)
+    
+    def set_autopilot(self, enabled):
+        """Hand the snake to the built-in bot, or give it back to the keyboard"""
+        self.autopilot = enabled
+        pygame.display.set_caption("Nokia Snake (autopilot)" if enabled else "Nokia Snake")
     
     def handle_key_press(self, key):
         """Handle keyboard input for game control"""
-        if key == pygame.K_UP or key == pygame.K_w:
+        if key == pygame.K_p:
+            self.set_autopilot(not self.autopilot)
+        elif key == pygame.K_ESCAPE:
+            self.phase = GamePhase.START_MENU
+            snake_lib.reset_game(self.game_state)
+        elif self.autopilot:
+            return  # Turns come from the bot while it drives
+        elif key == pygame.K_UP or key == pygame.K_w:
             snake_lib.set_direction(self.game_state, Direction.UP)
         elif key == pygame.K_RIGHT or key == pygame.K_d:
             snake_lib.set_direction(self.game_state, Direction.RIGHT)
@@ -226,9 +567,6 @@ class SnakeGame:
             snake_lib.set_direction(self.game_state, Direction.DOWN)
         elif key == pygame.K_LEFT or key == pygame.K_a:
             snake_lib.set_direction(self.game_state, Direction.LEFT)
-        elif key == pygame.K_ESCAPE:
-            self.phase = GamePhase.START_MENU
-            snake_lib.reset_game(self.game_state)
     
     def update_game_speed(self):
         """Update game speed based on score"""
@@ -256,14 +594,196 @@ class SnakeGame:
     
     def render_game(self):
         """Render the current game state to the screen"""
+        # Background, border and wall markers come pre-rendered
+        self.screen.blit(self.cached_surface("background", self.build_background_surface), (0, 0))
+        
+        # Draw food with pulsing effect
+        food_pos = snake_lib.get_food_position(self.game_state)
+        self.draw_food(food_pos)
+        
+        # Draw snake (one library call fetches every segment). A head or tail
+        # on its way to another cell is drawn last, at its in-between position
+        sprites = self.moving_segments()
+        head_moving, tail_cell = self.sprite_layout(sprites)
+        snake_length = snake_lib.copy_snake_segments(self.game_state, self.segment_buffer,
+                                                     len(self.segment_buffer))
+        for i in range(snake_length):
+            segment = self.segment_buffer[i]
+            if (segment.x, segment.y) != tail_cell:
+                self.draw_segment(segment, i == 0 and not head_moving)
+        self.draw_sprites(sprites)
+        
+        # Draw teleport and eat effects if active
+        self.draw_effects()
+        
+        # Draw score
+        self.draw_score()
+    
+    def build_background_surface(self):
+        """Draw the empty board with its border and wall markers onto a new surface"""
+        surface = pygame.Surface((WINDOW_WIDTH, WINDOW_HEIGHT))
+        
         # Fill the background
-        self.screen.fill(NOKIA_DARKEST)
+        surface.fill(NOKIA_DARKEST)
         
         # Draw border
-        pygame.draw.rect(self.screen, NOKIA_GREEN, (0, 0, WINDOW_WIDTH, WINDOW_HEIGHT), 2)
+        pygame.draw.rect(surface, NOKIA_GREEN, (0, 0, WINDOW_WIDTH, WINDOW_HEIGHT), 2)
         
-        # Draw food with pulsing effect
+        # Draw border indicators for teleportation (Nokia style wall markers)
+        for i in range(0, GRID_WIDTH):
+            pygame.draw.rect(surface, NOKIA_GREEN, 
+                           (i * CELL_SIZE + CELL_SIZE//2 - 1, 0, 2, 2))
+            pygame.draw.rect(surface, NOKIA_GREEN, 
+                           (i * CELL_SIZE + CELL_SIZE//2 - 1, WINDOW_HEIGHT-2, 2, 2))
+        for i in range(0, GRID_HEIGHT):
+            pygame.draw.rect(surface, NOKIA_GREEN, 
+                           (0, i * CELL_SIZE + CELL_SIZE//2 - 1, 2, 2))
+            pygame.draw.rect(surface, NOKIA_GREEN, 
+                           (WINDOW_WIDTH-2, i * CELL_SIZE + CELL_SIZE//2 - 1, 2, 2))
+        
+        return surface
+    
+    def cached_surface(self, key, build, version=None):
+        """Return the surface stored under key, building it on first use or when version changes"""
+        entry = self.surface_cache.get(key)
+        if entry is None or entry[0] != version or not SURFACE_CACHE_ENABLED:
+            entry = (version, build())
+            self.surface_cache[key] = entry
+        return entry[1]
+    
+    def moving_segments(self):
+        """Head and tail drawn part of the way to the cells the next tick moves them to"""
+        shift = int(self.motion * CELL_SIZE)
+        if shift == 0 or self.game_state.game_over or self.game_state.snake_length < 2:
+            return []
+        
+        sprites = []
+        head = snake_lib.get_snake_segment(self.game_state, 0)
+        step_x, step_y = DIRECTION_STEPS[Direction(snake_lib.peek_direction(self.game_state))]
+        ahead = Point(head.x + step_x, head.y + step_y)
+        food_pos = snake_lib.get_food_position(self.game_state)
+        
+        # The tail stays put when the next tick eats the food
+        if (ahead.x, ahead.y) != (food_pos.x, food_pos.y):
+            tail = snake_lib.get_snake_segment(self.game_state, self.game_state.snake_length - 1)
+            before = snake_lib.get_snake_segment(self.game_state, self.game_state.snake_length - 2)
+            toward_x, toward_y = before.x - tail.x, before.y - tail.y
+            if abs(toward_x) + abs(toward_y) == 1:  # Not across a wrapped edge
+                sprites.append((tail, False, toward_x * shift, toward_y * shift))
+        
+        # A head about to wrap around is not slid off the board
+        if 0 <= ahead.x < GRID_WIDTH and 0 <= ahead.y < GRID_HEIGHT:
+            sprites.append((head, True, step_x * shift, step_y * shift))
+        return sprites
+    
+    def sprite_layout(self, sprites):
+        """Whether the head is sliding, and the cell a sliding tail has left"""
+        head_moving = False
+        tail_cell = None
+        for segment, is_head, offset_x, offset_y in sprites:
+            if is_head:
+                head_moving = True
+            else:
+                tail_cell = (segment.x, segment.y)
+        return head_moving, tail_cell
+    
+    def sprite_cells(self, sprites):
+        """Grid cells the sliding segments overlap"""
+        cells = []
+        for segment, is_head, offset_x, offset_y in sprites:
+            cells.extend(self.cells_in_rect(self.cell_rect(segment.x, segment.y).move(offset_x, offset_y)))
+        return cells
+    
+    def draw_sprites(self, sprites):
+        """Draw the sliding segments over the board and remember the cells they cover"""
+        for segment, is_head, offset_x, offset_y in sprites:
+            self.draw_segment(segment, is_head, offset_x, offset_y)
+        self.drawn_sprite_cells = self.sprite_cells(sprites)
+    
+    def render_dirty(self, delta):
+        """Repaint only the cells changed since the last frame; returns the rects to push"""
+        cells = set()
+        
+        # Cells the snake and food moved through this tick, if one ran
+        if delta is not None and delta.moved:
+            cells.add((delta.new_head.x, delta.new_head.y))
+            if delta.vacated_tail.x >= 0:
+                cells.add((delta.vacated_tail.x, delta.vacated_tail.y))
+            if delta.old_food.x >= 0:
+                cells.add((delta.old_food.x, delta.old_food.y))
+            if self.game_state.snake_length > 1:
+                # The old head becomes a plain body segment
+                neck = snake_lib.get_snake_segment(self.game_state, 1)
+                cells.add((neck.x, neck.y))
+        
+        # Sliding segments must be erased from last frame's cells, drawn in the new ones
+        sprites = self.moving_segments()
+        head_moving, tail_cell = self.sprite_layout(sprites)
+        cells.update(self.drawn_sprite_cells)
+        cells.update(self.sprite_cells(sprites))
+        
+        # The food pulses every tick
         food_pos = snake_lib.get_food_position(self.game_state)
+        if food_pos.x >= 0:
+            cells.add((food_pos.x, food_pos.y))
+        
+        # Effects drawn last frame must be erased, current ones drawn
+        effect_rects = self.effect_rects()
+        for rect in self.drawn_effect_rects + effect_rects:
+            cells.update(self.cells_in_rect(rect))
+        
+        # The score text sits on top of the board: repaint it whenever the score
+        # changes or a cell underneath it was repainted
+        score = self.game_state.score
+        score_dirty = score != self.drawn_score or any(
+            self.cell_rect(x, y).colliderect(self.score_rect) for x, y in cells)
+        if score_dirty:
+            cells.update(self.cells_in_rect(self.score_rect))
+        
+        head = snake_lib.get_snake_segment(self.game_state, 0)
+        for x, y in cells:
+            self.repaint_cell(x, y, head, food_pos, head_moving, tail_cell)
+        
+        self.draw_sprites(sprites)
+        self.draw_effects()
+        if score_dirty:
+            self.draw_score()
+            cells.update(self.cells_in_rect(self.score_rect))
+        
+        return [self.cell_rect(x, y) for x, y in cells]
+    
+    def repaint_cell(self, x, y, head, food_pos, head_moving, tail_cell):
+        """Restore one cell from the background and redraw its food and resting snake segment"""
+        rect = self.cell_rect(x, y)
+        background = self.cached_surface("background", self.build_background_surface)
+        self.screen.blit(background, rect, rect)
+        
+        if x == food_pos.x and y == food_pos.y:
+            self.draw_food(food_pos)
+        if (x, y) == tail_cell:
+            return  # Drawn as a sliding segment
+        if x == head.x and y == head.y:
+            # A sliding head leaves a body segment behind
+            self.draw_segment(head, not head_moving)
+        elif self.occupied[y * self.game_state.width + x]:
+            self.draw_segment(Point(x, y), False)
+    
+    def cell_rect(self, x, y):
+        """Screen rectangle covered by a grid cell"""
+        return pygame.Rect(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE)
+    
+    def cells_in_rect(self, rect):
+        """Grid cells overlapping a screen rectangle"""
+        left = max(rect.left // CELL_SIZE, 0)
+        right = min((rect.right - 1) // CELL_SIZE, GRID_WIDTH - 1)
+        top = max(rect.top // CELL_SIZE, 0)
+        bottom = min((rect.bottom - 1) // CELL_SIZE, GRID_HEIGHT - 1)
+        return [(x, y) for x in range(left, right + 1) for y in range(top, bottom + 1)]
+    
+    def draw_food(self, food_pos):
+        """Draw the food with its pulsing effect"""
+        if food_pos.x < 0:
+            return  # The snake covers the whole board
         food_color = NOKIA_LIGHT_GREEN
         pulse_size = int(1 + 0.5 * abs(round(2 * (abs(self.food_pulse - 1.57) / 3.14 - 0.5))))
         pygame.draw.rect(self.screen, food_color, 
@@ -271,71 +791,70 @@ class SnakeGame:
                          food_pos.y * CELL_SIZE + pulse_size, 
                          CELL_SIZE - 2*pulse_size, 
                          CELL_SIZE - 2*pulse_size))
-        
-        # Draw snake
-        snake_length = self.game_state.snake_length
-        for i in range(snake_length):
-            segment = snake_lib.get_snake_segment(self.game_state, i)
-            
-            # Determine color (head is lighter)
-            if i == 0:  # Head
-                color = NOKIA_LIGHT_GREEN
-                # Draw eyes on the head
-                eye_size = 2
-                eye_offset = 6
-                eye_color = NOKIA_DARKEST
-                
-                # Position eyes based on direction
-                if self.game_state.direction == Direction.UP:
-                    pygame.draw.rect(self.screen, eye_color, 
-                                    (segment.x * CELL_SIZE + eye_offset - 2, 
-                                     segment.y * CELL_SIZE + eye_offset - 3, 
-                                     eye_size, eye_size))
-                    pygame.draw.rect(self.screen, eye_color, 
-                                    (segment.x * CELL_SIZE + CELL_SIZE - eye_offset, 
-                                     segment.y * CELL_SIZE + eye_offset - 3, 
-                                     eye_size, eye_size))
-                elif self.game_state.direction == Direction.RIGHT:
-                    pygame.draw.rect(self.screen, eye_color, 
-                                    (segment.x * CELL_SIZE + CELL_SIZE - eye_offset + 3, 
-                                     segment.y * CELL_SIZE + eye_offset - 2, 
-                                     eye_size, eye_size))
-                    pygame.draw.rect(self.screen, eye_color, 
-                                    (segment.x * CELL_SIZE + CELL_SIZE - eye_offset + 3, 
-                                     segment.y * CELL_SIZE + CELL_SIZE - eye_offset, 
-                                     eye_size, eye_size))
-                elif self.game_state.direction == Direction.DOWN:
-                    pygame.draw.rect(self.screen, eye_color, 
-                                    (segment.x * CELL_SIZE + eye_offset - 2, 
-                                     segment.y * CELL_SIZE + CELL_SIZE - eye_offset + 3, 
-                                     eye_size, eye_size))
-                    pygame.draw.rect(self.screen, eye_color, 
-                                    (segment.x * CELL_SIZE + CELL_SIZE - eye_offset, 
-                                     segment.y * CELL_SIZE + CELL_SIZE - eye_offset + 3, 
-                                     eye_size, eye_size))
-                elif self.game_state.direction == Direction.LEFT:
-                    pygame.draw.rect(self.screen, eye_color, 
-                                    (segment.x * CELL_SIZE + eye_offset - 3, 
-                                     segment.y * CELL_SIZE + eye_offset - 2, 
-                                     eye_size, eye_size))
-                    pygame.draw.rect(self.screen, eye_color, 
-                                    (segment.x * CELL_SIZE + eye_offset - 3, 
-                                     segment.y * CELL_SIZE + CELL_SIZE - eye_offset, 
-                                     eye_size, eye_size))
-            else:  # Body
-                color = NOKIA_GREEN
-                # Every few segments, use a slightly darker color for visual effect
-                if i % 2 == 0:
-                    color = NOKIA_DARK_GREEN
+    
+    def draw_segment(self, segment, is_head, offset_x=0, offset_y=0):
+        """Draw one snake segment, optionally shifted by a pixel offset; the head gets
+        eyes facing the current direction"""
+        left = segment.x * CELL_SIZE + offset_x
+        top = segment.y * CELL_SIZE + offset_y
+        if is_head:
+            color = NOKIA_LIGHT_GREEN
+            # Draw eyes on the head
+            eye_size = 2
+            eye_offset = 6
+            eye_color = NOKIA_DARKEST
             
+            # Position eyes based on direction, including a turn queued for the next tick
+            direction = snake_lib.peek_direction(self.game_state)
+            if direction == Direction.UP:
+                eyes = [(left + eye_offset - 2, top + eye_offset - 3),
+                        (left + CELL_SIZE - eye_offset, top + eye_offset - 3)]
+            elif direction == Direction.RIGHT:
+                eyes = [(left + CELL_SIZE - eye_offset + 3, top + eye_offset - 2),
+                        (left + CELL_SIZE - eye_offset + 3, top + CELL_SIZE - eye_offset)]
+            elif direction == Direction.DOWN:
+                eyes = [(left + eye_offset - 2, top + CELL_SIZE - eye_offset + 3),
+                        (left + CELL_SIZE - eye_offset, top + CELL_SIZE - eye_offset + 3)]
+            else:
+                eyes = [(left + eye_offset - 3, top + eye_offset - 2),
+                        (left + eye_offset - 3, top + CELL_SIZE - eye_offset)]
+            gap = 0
+        else:
+            color = NOKIA_GREEN
+            # Alternate shades by cell so the stripes stay put as the snake moves
+            # and a tick only changes the cells at the head and tail
+            if (segment.x + segment.y) % 2 == 0:
+                color = NOKIA_DARK_GREEN
+            eyes = []
             # Draw the segment with a small gap to create segmented look
-            gap = 1 if i > 0 else 0
-            pygame.draw.rect(self.screen, color, 
-                            (segment.x * CELL_SIZE + gap, 
-                             segment.y * CELL_SIZE + gap, 
-                             CELL_SIZE - 2*gap, 
-                             CELL_SIZE - 2*gap))
-        
+            gap = 1
+        
+        for eye_x, eye_y in eyes:
+            pygame.draw.rect(self.screen, eye_color, (eye_x, eye_y, eye_size, eye_size))
+        pygame.draw.rect(self.screen, color, 
+                        (left + gap, 
+                         top + gap, 
+                         CELL_SIZE - 2*gap, 
+                         CELL_SIZE - 2*gap))
+    
+    def effect_rects(self):
+        """Screen areas covered by the active effects"""
+        rects = []
+        if self.teleport_effect is not None:
+            pos, time_left, color = self.teleport_effect
+            radius = (10 - time_left) * 2
+            rects.append(pygame.Rect(pos.x * CELL_SIZE + CELL_SIZE//2 - radius - 1,
+                                     pos.y * CELL_SIZE + CELL_SIZE//2 - radius - 1,
+                                     2 * radius + 2, 2 * radius + 2))
+        if self.eat_effect is not None:
+            pos, time_left, size = self.eat_effect
+            rects.append(pygame.Rect(pos.x * CELL_SIZE + (CELL_SIZE - size)//2 - 1,
+                                     pos.y * CELL_SIZE + (CELL_SIZE - size)//2 - 1,
+                                     size + 2, size + 2))
+        return rects
+    
+    def draw_effects(self):
+        """Draw the teleport and eat effects and remember where they were drawn"""
         # Draw teleport effect if active
         if self.teleport_effect is not None:
             pos, time_left, color = self.teleport_effect
@@ -354,22 +873,16 @@ class SnakeGame:
                              pos.y * CELL_SIZE + (CELL_SIZE - size)//2, 
                              size, size))
         
-        # Draw score
-        score_text = self.small_font.render(f"Score: {snake_lib.get_score(self.game_state)}", 
-                                          True, NOKIA_GREEN)
-        self.screen.blit(score_text, (10, 10))
-        
-        # Draw border indicators for teleportation (Nokia style wall markers)
-        for i in range(0, GRID_WIDTH):
-            pygame.draw.rect(self.screen, NOKIA_GREEN, 
-                           (i * CELL_SIZE + CELL_SIZE//2 - 1, 0, 2, 2))
-            pygame.draw.rect(self.screen, NOKIA_GREEN, 
-                           (i * CELL_SIZE + CELL_SIZE//2 - 1, WINDOW_HEIGHT-2, 2, 2))
-        for i in range(0, GRID_HEIGHT):
-            pygame.draw.rect(self.screen, NOKIA_GREEN, 
-                           (0, i * CELL_SIZE + CELL_SIZE//2 - 1, 2, 2))
-            pygame.draw.rect(self.screen, NOKIA_GREEN, 
-                           (WINDOW_WIDTH-2, i * CELL_SIZE + CELL_SIZE//2 - 1, 2, 2))
+        self.drawn_effect_rects = self.effect_rects()
+    
+    def draw_score(self):
+        """Draw the score in the top-left corner and remember its area"""
+        score = snake_lib.get_score(self.game_state)
+        # Only re-render the text when the score changes
+        score_text = self.cached_surface(
+            "score", lambda: self.small_font.render(f"Score: {score}", True, NOKIA_GREEN), score)
+        self.score_rect = self.screen.blit(score_text, (10, 10))
+        self.drawn_score = score
     
     def handle_game_over(self):
         """Handle the game over phase"""
@@ -384,14 +897,28 @@ class SnakeGame:
                 elif event.key == pygame.K_ESCAPE:
                     self.running = False
         
-        # Render game over screen
+        # Render game over screen: the board is frozen, so the whole dimmed
+        # frame is composed once per game over and reused
+        frame = self.cached_surface("game over", self.build_game_over_surface, self.game_over_count)
+        self.screen.blit(frame, (0, 0))
+        
+        # Make the text blink at game over
+        current_time = int(time.time() * 2)  # 2 blinks per second
+        if current_time % 2 == 0:
+            restart_text = self.cached_surface(
+                "retry", lambda: self.small_font.render("RETRY", True, NOKIA_LIGHT_GREEN))
+            restart_rect = restart_text.get_rect(center=(WINDOW_WIDTH//2, WINDOW_HEIGHT*3//4))
+            self.screen.blit(restart_text, restart_rect)
+        
+        pygame.display.flip()
+    
+    def build_game_over_surface(self):
+        """Compose the final board, the dimming overlay and the game over text"""
         # Keep the game state visible in the background
         self.render_game()
         
         # Draw semi-transparent overlay
-        overlay = pygame.Surface((WINDOW_WIDTH, WINDOW_HEIGHT), pygame.SRCALPHA)
-        overlay.fill((NOKIA_DARKEST[0], NOKIA_DARKEST[1], NOKIA_DARKEST[2], 200))
-        self.screen.blit(overlay, (0, 0))
+        self.screen.blit(self.cached_surface("overlay", self.build_overlay_surface), (0, 0))
         
         # Draw game over text
         game_over_text = self.font.render("GAME OVER", True, NOKIA_GREEN)
@@ -409,14 +936,13 @@ class SnakeGame:
         instruction_rect = instruction_text.get_rect(center=(WINDOW_WIDTH//2, WINDOW_HEIGHT*2//3))
         self.screen.blit(instruction_text, instruction_rect)
         
-        # Make the text blink at game over
-        current_time = int(time.time() * 2)  # 2 blinks per second
-        if current_time % 2 == 0:
-            restart_text = self.small_font.render("RETRY", True, NOKIA_LIGHT_GREEN)
-            restart_rect = restart_text.get_rect(center=(WINDOW_WIDTH//2, WINDOW_HEIGHT*3//4))
-            self.screen.blit(restart_text, restart_rect)
-        
-        pygame.display.flip()
+        return self.screen.copy()
+    
+    def build_overlay_surface(self):
+        """Create the semi-transparent overlay used to dim the board"""
+        overlay = pygame.Surface((WINDOW_WIDTH, WINDOW_HEIGHT), pygame.SRCALPHA)
+        overlay.fill((NOKIA_DARKEST[0], NOKIA_DARKEST[1], NOKIA_DARKEST[2], 200))
+        return overlay
     
     def check_wall_teleport(self, prev_pos, new_pos):
         """Check if teleportation occurred and trigger effect if needed"""
@@ -439,4 +965,10 @@ if __name__ == "__main__":
     
     # Clean up when exiting
     pygame.quit()
+    print(game.frame_timer.report())
+    print(game.input_latency.report())
+    game.tracer.close()
+    if snake_lib.profile_enabled():
+        print("Core profile:")
+        print(core_profile_json())
     print("Game exited successfully.")